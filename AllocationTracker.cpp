@@ -0,0 +1,543 @@
+#include "AllocationTracker.h"
+#include <imgui.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+namespace {
+
+constexpr std::memory_order RELAXED = std::memory_order_relaxed;
+
+// 以下全局状态都是常量初始化、平凡析构的：
+// 动态初始化阶段就会有分配，全局对象析构之后也还会有释放（如全局对象中的绘制列表）
+
+// 每线程的计数块：只有所属线程写入（读出再写回，不用原子的读改写），按缓存行对齐，
+// 线程之间不共享任何被写的缓存行；统计时遍历所有块求和。
+// 块在线程第一次分配时从未统计的堆内存创建，线程退出后保留（累计值不能丢），每个线程64字节的量级
+struct alignas(64) ThreadCounters {
+    std::atomic<size_t> allocations{ 0 };
+    std::atomic<size_t> frees{ 0 };
+    std::atomic<size_t> bytes{ 0 };
+    std::atomic<size_t> freedBytes{ 0 };     // 本线程释放的字节数（可能是其他线程分配的）
+    std::atomic<size_t> imguiRequests{ 0 };
+    std::atomic<size_t> frameEpoch{ 0 };     // framePeak所属的帧
+    std::atomic<size_t> framePeak{ 0 };      // 该帧内本线程净存活字节数相对帧初的最大增量
+    // 以下只由所属线程访问
+    size_t frameBase = 0;                    // 该帧第一次分配前的净存活字节数
+    size_t scopePeak = 0;                    // 当前作用域内净存活字节数的最大值（AllocationScope）
+    ThreadCounters* next = nullptr;
+
+    size_t Net() const { return bytes.load(RELAXED) - freedBytes.load(RELAXED); } // 可能“为负”（按无符号回绕）
+};
+
+void Increase(std::atomic<size_t>& counter, size_t amount) {
+    counter.store(counter.load(RELAXED) + amount, RELAXED);
+}
+
+// 按无符号回绕比较的净字节数
+bool NetGreater(size_t a, size_t b) {
+    return static_cast<std::ptrdiff_t>(a - b) > 0;
+}
+
+std::atomic<ThreadCounters*> g_threads{ nullptr }; // 所有线程的计数块（只增不减的链表）
+std::atomic<size_t> g_frameEpoch{ 1 };             // BeginFrame递增，各线程据此重置帧内峰值
+thread_local ThreadCounters* t_counters = nullptr;
+
+ThreadCounters& GetThreadCounters() {
+    if (!t_counters) {
+        // 不能经过operator new（正在其中），直接从堆取一块并手动对齐
+        void* raw = std::calloc(1, sizeof(ThreadCounters) + alignof(ThreadCounters));
+        if (!raw) std::abort();
+        const uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + alignof(ThreadCounters) - 1) & ~uintptr_t(alignof(ThreadCounters) - 1);
+        ThreadCounters* counters = new (reinterpret_cast<void*>(aligned)) ThreadCounters();
+        counters->next = g_threads.load(RELAXED);
+        while (!g_threads.compare_exchange_weak(counters->next, counters, std::memory_order_release, RELAXED)) {
+        }
+        t_counters = counters;
+    }
+    return *t_counters;
+}
+
+template<typename Function>
+void ForEachThread(Function&& function) {
+    for (const ThreadCounters* counters = g_threads.load(std::memory_order_acquire); counters; counters = counters->next) {
+        function(*counters);
+    }
+}
+
+// 自旋锁：锁住的区间只有几条指令
+class SpinLock {
+public:
+    explicit SpinLock(std::atomic_flag& flag) : flag(flag) {
+        while (flag.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+    ~SpinLock() { flag.clear(std::memory_order_release); }
+    SpinLock(const SpinLock&) = delete;
+    SpinLock& operator=(const SpinLock&) = delete;
+
+private:
+    std::atomic_flag& flag;
+};
+
+void CountAllocation(size_t bytes) {
+    ThreadCounters& counters = GetThreadCounters();
+    Increase(counters.allocations, 1);
+    Increase(counters.bytes, bytes);
+    const size_t net = counters.Net();
+
+    // 帧内峰值：本线程在新的一帧第一次分配时以分配前的净值为起点
+    const size_t epoch = g_frameEpoch.load(RELAXED);
+    if (counters.frameEpoch.load(RELAXED) != epoch) {
+        counters.frameBase = net - bytes;
+        counters.framePeak.store(0, RELAXED);
+        counters.frameEpoch.store(epoch, RELAXED);
+    }
+    if (NetGreater(net, counters.frameBase + counters.framePeak.load(RELAXED))) {
+        counters.framePeak.store(net - counters.frameBase, RELAXED);
+    }
+    if (NetGreater(net, counters.scopePeak)) counters.scopePeak = net;
+}
+
+void CountFree(size_t bytes) {
+    ThreadCounters& counters = GetThreadCounters();
+    Increase(counters.frees, 1);
+    Increase(counters.freedBytes, bytes);
+}
+
+// 分配和释放都按实际可用大小计数，存活字节数才能对上
+size_t UsableSize(void* p) {
+#if defined(_WIN32)
+    return _msize(p);
+#elif defined(__APPLE__)
+    return malloc_size(p);
+#else
+    return malloc_usable_size(p);
+#endif
+}
+
+void* TrackedMalloc(size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (p) CountAllocation(UsableSize(p));
+    return p;
+}
+
+void TrackedFree(void* p) {
+    if (!p) return;
+    CountFree(UsableSize(p));
+    std::free(p);
+}
+
+void* TrackedAlignedMalloc(size_t size, size_t alignment) {
+#if defined(_WIN32)
+    void* p = _aligned_malloc(size ? size : 1, alignment);
+    if (p) CountAllocation(_aligned_msize(p, alignment, 0));
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, std::max(alignment, sizeof(void*)), size ? size : 1) != 0) return nullptr;
+    CountAllocation(UsableSize(p));
+#endif
+    return p;
+}
+
+void TrackedAlignedFree(void* p, size_t alignment) {
+    if (!p) return;
+#if defined(_WIN32)
+    CountFree(_aligned_msize(p, alignment, 0));
+    _aligned_free(p);
+#else
+    (void)alignment;
+    TrackedFree(p);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////// ImGui分配函数
+void* ImGuiHeapAlloc(size_t size, void*) {
+    Increase(GetThreadCounters().imguiRequests, 1);
+    return TrackedMalloc(size);
+}
+
+void ImGuiHeapFree(void* ptr, void*) {
+    TrackedFree(ptr);
+}
+
+// arena模式：按2的幂分级的块池，释放的块挂到对应级别的空闲链表，不还给堆。
+// 小块从大块内存中切出，大块（如顶点缓冲区）单独从堆分配
+constexpr int POOL_MIN_SHIFT = 4;        // 最小块16字节
+constexpr int POOL_CHUNK_SHIFT = 16;     // 不超过64KB的块从大块内存中切出
+constexpr int POOL_MAX_SHIFT = 26;       // 最大块64MB，更大的请求直接从堆分配和释放
+constexpr int POOL_CLASS_COUNT = POOL_MAX_SHIFT - POOL_MIN_SHIFT + 1;
+constexpr size_t POOL_CHUNK_BYTES = 256 * 1024;
+constexpr size_t BLOCK_HEADER = 16;      // 块头保存大小级别，同时保持16字节对齐
+constexpr unsigned int LARGE_BLOCK = ~0u;
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+// ImGui的绘制列表可能在工作线程中增长（区域几何的临时列表），需要加锁
+struct ArenaState {
+    std::atomic_flag lock = ATOMIC_FLAG_INIT;
+    FreeBlock* freeLists[POOL_CLASS_COUNT] = {};
+    char* chunkCursor = nullptr;
+    char* chunkEnd = nullptr;
+};
+
+ArenaState g_arena;
+
+void* ImGuiArenaAlloc(size_t size, void*) {
+    Increase(GetThreadCounters().imguiRequests, 1);
+    int sizeClass = 0;
+    while (sizeClass < POOL_CLASS_COUNT && (size_t(1) << (sizeClass + POOL_MIN_SHIFT)) < size) {
+        sizeClass++;
+    }
+    if (sizeClass == POOL_CLASS_COUNT) {
+        char* block = static_cast<char*>(TrackedMalloc(size + BLOCK_HEADER));
+        if (!block) return nullptr;
+        *reinterpret_cast<unsigned int*>(block) = LARGE_BLOCK;
+        return block + BLOCK_HEADER;
+    }
+
+    SpinLock lock(g_arena.lock);
+    char* block;
+    if (FreeBlock* free = g_arena.freeLists[sizeClass]) {
+        g_arena.freeLists[sizeClass] = free->next;
+        block = reinterpret_cast<char*>(free);
+    }
+    else if (sizeClass + POOL_MIN_SHIFT > POOL_CHUNK_SHIFT) {
+        block = static_cast<char*>(TrackedMalloc(BLOCK_HEADER + (size_t(1) << (sizeClass + POOL_MIN_SHIFT))));
+        if (!block) return nullptr;
+    }
+    else {
+        const size_t blockBytes = BLOCK_HEADER + (size_t(1) << (sizeClass + POOL_MIN_SHIFT));
+        if (static_cast<size_t>(g_arena.chunkEnd - g_arena.chunkCursor) < blockBytes) {
+            // 旧大块的剩余部分不再使用
+            char* chunk = static_cast<char*>(TrackedMalloc(POOL_CHUNK_BYTES));
+            if (!chunk) return nullptr;
+            g_arena.chunkCursor = chunk;
+            g_arena.chunkEnd = chunk + POOL_CHUNK_BYTES;
+        }
+        block = g_arena.chunkCursor;
+        g_arena.chunkCursor += blockBytes;
+    }
+    *reinterpret_cast<unsigned int*>(block) = static_cast<unsigned int>(sizeClass);
+    return block + BLOCK_HEADER;
+}
+
+void ImGuiArenaFree(void* ptr, void*) {
+    if (!ptr) return;
+    char* block = static_cast<char*>(ptr) - BLOCK_HEADER;
+    const unsigned int sizeClass = *reinterpret_cast<unsigned int*>(block);
+    if (sizeClass == LARGE_BLOCK) {
+        TrackedFree(block);
+        return;
+    }
+    SpinLock lock(g_arena.lock);
+    FreeBlock* free = reinterpret_cast<FreeBlock*>(block);
+    free->next = g_arena.freeLists[sizeClass];
+    g_arena.freeLists[sizeClass] = free;
+}
+
+///////////////////////////////////////////////////////////////////////////// 帧和作用域统计
+constexpr int MAX_SCOPES = 64; // 超出的作用域不统计
+
+struct ScopeRegistry {
+    std::atomic_flag lock = ATOMIC_FLAG_INIT;
+    AllocationScopeStats scopes[MAX_SCOPES];
+    AllocationCounters pending[MAX_SCOPES]; // 本帧累加中
+    size_t pendingPeak[MAX_SCOPES] = {};
+    int count = 0;
+};
+
+ScopeRegistry g_scopes;
+
+// 以下只在调用BeginFrame/EndFrame的线程使用
+struct FrameState {
+    AllocationCounters start;
+    size_t imguiStart = 0;
+    size_t liveStart = 0;
+    AllocationFrameStats last;
+    bool expectZero = false;
+    int warmupFrames = 0;
+    int frameIndex = 0;      // ExpectZeroSteadyState之后的帧序号
+    int checkedFrames = 0;
+    int violations = 0;
+    char firstViolation[512] = {};
+};
+
+FrameState g_frame;
+
+void Add(AllocationCounters& to, const AllocationCounters& delta) {
+    to.allocations += delta.allocations;
+    to.frees += delta.frees;
+    to.bytes += delta.bytes;
+}
+
+AllocationCounters Subtract(const AllocationCounters& a, const AllocationCounters& b) {
+    AllocationCounters delta;
+    delta.allocations = a.allocations - b.allocations;
+    delta.frees = a.frees - b.frees;
+    delta.bytes = a.bytes - b.bytes;
+    return delta;
+}
+
+// 第一次违规的明细（不分配内存）
+void FormatViolation(int frameIndex) {
+    const AllocationCounters& counters = g_frame.last.counters;
+    char* out = g_frame.firstViolation;
+    const size_t capacity = sizeof(g_frame.firstViolation);
+    size_t length = static_cast<size_t>(std::snprintf(out, capacity, "frame %d: %zu allocations, %zu bytes",
+        frameIndex, counters.allocations, counters.bytes));
+    for (int i = 0; i < g_scopes.count && length < capacity; i++) {
+        const AllocationScopeStats& scope = g_scopes.scopes[i];
+        if (scope.frame.allocations == 0) continue;
+        length += static_cast<size_t>(std::snprintf(out + length, capacity - length, "; %s: %zu",
+            scope.name, scope.frame.allocations));
+    }
+}
+
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////// 全局new/delete
+void* operator new(size_t size) {
+    if (void* p = TrackedMalloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    if (void* p = TrackedMalloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return TrackedMalloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return TrackedMalloc(size); }
+
+void operator delete(void* p) noexcept { TrackedFree(p); }
+void operator delete[](void* p) noexcept { TrackedFree(p); }
+void operator delete(void* p, size_t) noexcept { TrackedFree(p); }
+void operator delete[](void* p, size_t) noexcept { TrackedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { TrackedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { TrackedFree(p); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* p = TrackedAlignedMalloc(size, static_cast<size_t>(alignment))) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    if (void* p = TrackedAlignedMalloc(size, static_cast<size_t>(alignment))) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p, std::align_val_t alignment) noexcept { TrackedAlignedFree(p, static_cast<size_t>(alignment)); }
+void operator delete[](void* p, std::align_val_t alignment) noexcept { TrackedAlignedFree(p, static_cast<size_t>(alignment)); }
+void operator delete(void* p, size_t, std::align_val_t alignment) noexcept { TrackedAlignedFree(p, static_cast<size_t>(alignment)); }
+void operator delete[](void* p, size_t, std::align_val_t alignment) noexcept { TrackedAlignedFree(p, static_cast<size_t>(alignment)); }
+
+///////////////////////////////////////////////////////////////////////////// AllocationTracker
+void AllocationTracker::InstallImGuiAllocator(bool useArena) {
+    if (useArena) {
+        ImGui::SetAllocatorFunctions(ImGuiArenaAlloc, ImGuiArenaFree, nullptr);
+    }
+    else {
+        ImGui::SetAllocatorFunctions(ImGuiHeapAlloc, ImGuiHeapFree, nullptr);
+    }
+}
+
+AllocationCounters AllocationTracker::GetTotals() {
+    AllocationCounters totals;
+    ForEachThread([&](const ThreadCounters& counters) {
+        totals.allocations += counters.allocations.load(RELAXED);
+        totals.frees += counters.frees.load(RELAXED);
+        totals.bytes += counters.bytes.load(RELAXED);
+    });
+    return totals;
+}
+
+size_t AllocationTracker::GetLiveBytes() {
+    size_t live = 0;
+    ForEachThread([&](const ThreadCounters& counters) { live += counters.Net(); });
+    return live;
+}
+
+static size_t GetImGuiRequests() {
+    size_t requests = 0;
+    ForEachThread([&](const ThreadCounters& counters) { requests += counters.imguiRequests.load(RELAXED); });
+    return requests;
+}
+
+void AllocationTracker::BeginFrame() {
+    g_frame.start = GetTotals();
+    g_frame.imguiStart = GetImGuiRequests();
+    g_frame.liveStart = GetLiveBytes();
+    g_frameEpoch.fetch_add(1, RELAXED);
+}
+
+void AllocationTracker::EndFrame() {
+    AllocationFrameStats& last = g_frame.last;
+    last.counters = Subtract(GetTotals(), g_frame.start);
+    last.liveBytes = GetLiveBytes();
+    last.imguiRequests = GetImGuiRequests() - g_frame.imguiStart;
+
+    // 峰值为帧初存活字节数加上各线程帧内的最大增量：只有一个线程分配时准确，多个线程时是上界
+    const size_t epoch = g_frameEpoch.load(RELAXED);
+    size_t growth = 0;
+    ForEachThread([&](const ThreadCounters& counters) {
+        if (counters.frameEpoch.load(RELAXED) == epoch) growth += counters.framePeak.load(RELAXED);
+    });
+    last.peakBytes = std::max(g_frame.liveStart + growth, last.liveBytes);
+
+    {
+        SpinLock lock(g_scopes.lock);
+        for (int i = 0; i < g_scopes.count; i++) {
+            g_scopes.scopes[i].frame = g_scopes.pending[i];
+            g_scopes.scopes[i].framePeakBytes = g_scopes.pendingPeak[i];
+            g_scopes.pending[i] = AllocationCounters();
+            g_scopes.pendingPeak[i] = 0;
+        }
+    }
+
+    if (g_frame.expectZero) {
+        const int frameIndex = g_frame.frameIndex++;
+        if (frameIndex >= g_frame.warmupFrames) {
+            g_frame.checkedFrames++;
+            if (last.counters.allocations > 0 && g_frame.violations++ == 0) {
+                FormatViolation(frameIndex);
+            }
+        }
+    }
+}
+
+const AllocationFrameStats& AllocationTracker::GetLastFrame() {
+    return g_frame.last;
+}
+
+int AllocationTracker::GetScopeCount() {
+    SpinLock lock(g_scopes.lock);
+    return g_scopes.count;
+}
+
+const AllocationScopeStats& AllocationTracker::GetScope(int index) {
+    return g_scopes.scopes[index];
+}
+
+void AllocationTracker::ResetScopeTotals() {
+    SpinLock lock(g_scopes.lock);
+    for (int i = 0; i < g_scopes.count; i++) {
+        g_scopes.scopes[i].total = AllocationCounters();
+        g_scopes.scopes[i].peakBytes = 0;
+    }
+}
+
+void AllocationTracker::ExpectZeroSteadyState(int warmupFrames) {
+    g_frame.expectZero = true;
+    g_frame.warmupFrames = std::max(0, warmupFrames);
+    g_frame.frameIndex = 0;
+    g_frame.checkedFrames = 0;
+    g_frame.violations = 0;
+    g_frame.firstViolation[0] = '\0';
+}
+
+bool AllocationTracker::CheckZeroSteadyState(std::string* error) {
+    if (g_frame.violations == 0) return true;
+    if (error) {
+        *error = std::to_string(g_frame.violations) + " of " + std::to_string(g_frame.checkedFrames) +
+            " steady-state frames allocated, first at " + g_frame.firstViolation;
+    }
+    return false;
+}
+
+void AllocationTracker::DrawOverlay(bool* open) {
+    const AllocationFrameStats& last = g_frame.last;
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    if (!ImGui::Begin("Allocations", open, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings)) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Text("Frame: %zu allocs, %zu frees, %.1f KB", last.counters.allocations, last.counters.frees,
+        last.counters.bytes / 1024.0);
+    ImGui::Text("Live: %.1f KB (frame peak %.1f KB), ImGui requests: %zu", last.liveBytes / 1024.0,
+        last.peakBytes / 1024.0, last.imguiRequests);
+
+    if (ImGui::BeginTable("##allocScopes", 5)) {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("Allocs");
+        ImGui::TableSetupColumn("KB");
+        ImGui::TableSetupColumn("Peak KB");
+        ImGui::TableSetupColumn("Total allocs");
+        ImGui::TableHeadersRow();
+        const int count = GetScopeCount();
+        for (int i = 0; i < count; i++) {
+            const AllocationScopeStats& scope = g_scopes.scopes[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(scope.name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", scope.frame.allocations);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", scope.frame.bytes / 1024.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", scope.peakBytes / 1024.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", scope.total.allocations);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+///////////////////////////////////////////////////////////////////////////// AllocationScope
+AllocationScope::AllocationScope(const char* name)
+    : name(name) {
+    ThreadCounters& counters = GetThreadCounters();
+    start.allocations = counters.allocations.load(RELAXED);
+    start.frees = counters.frees.load(RELAXED);
+    start.bytes = counters.bytes.load(RELAXED);
+    startNet = counters.Net();
+    outerPeak = counters.scopePeak;
+    counters.scopePeak = startNet;
+}
+
+AllocationScope::~AllocationScope() {
+    ThreadCounters& counters = GetThreadCounters();
+    AllocationCounters now;
+    now.allocations = counters.allocations.load(RELAXED);
+    now.frees = counters.frees.load(RELAXED);
+    now.bytes = counters.bytes.load(RELAXED);
+    const AllocationCounters delta = Subtract(now, start);
+
+    // 作用域内本线程存活字节数的最大增量；外层作用域的峰值包含内层的
+    const size_t peakNet = counters.scopePeak;
+    const size_t peak = NetGreater(peakNet, startNet) ? peakNet - startNet : 0;
+    counters.scopePeak = NetGreater(outerPeak, peakNet) ? outerPeak : peakNet;
+
+    SpinLock lock(g_scopes.lock);
+    int index = 0;
+    while (index < g_scopes.count && g_scopes.scopes[index].name != name &&
+        std::strcmp(g_scopes.scopes[index].name, name) != 0) {
+        index++;
+    }
+    if (index == g_scopes.count) {
+        if (index == MAX_SCOPES) return;
+        g_scopes.scopes[index].name = name;
+        g_scopes.count++;
+    }
+    Add(g_scopes.pending[index], delta);
+    Add(g_scopes.scopes[index].total, delta);
+    g_scopes.pendingPeak[index] = std::max(g_scopes.pendingPeak[index], peak);
+    g_scopes.scopes[index].peakBytes = std::max(g_scopes.scopes[index].peakBytes, peak);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+// 堆分配统计
+// 替换全局 operator new/delete，并可安装ImGui的分配函数，统计所有线程的堆分配次数、字节数和存活字节数。
+// 各线程只写自己的计数块（不共享被写的缓存行，没有原子的读改写），读取统计时对所有线程求和。
+//
+//   AllocationTracker::InstallImGuiAllocator(useArena); // ImGui::CreateContext之前调用
+//   AllocationTracker::BeginFrame(); ... AllocationTracker::EndFrame(); // 每帧汇总
+//   ALLOC_SCOPE("Name");  // 作用域统计（包含嵌套作用域，只统计本线程），名称必须是字符串字面量
+//
+// arena模式下ImGui的内部缓冲区从按2的幂分级的块池中分配，释放的块留在池中复用，
+// 稳态下ImGui的缓冲区增长/收缩不再触及堆（池本身的块从堆分配，计入统计）。
+//
+// 稳态零分配检查（供测试和基准使用）：
+//   AllocationTracker::ExpectZeroSteadyState(warmupFrames);
+//   ...运行若干帧...
+//   if (!AllocationTracker::CheckZeroSteadyState(&error)) { 失败 }
+
+#include <cstddef>
+#include <string>
+
+struct AllocationCounters {
+    size_t allocations = 0; // 堆分配次数
+    size_t frees = 0;       // 释放次数
+    size_t bytes = 0;       // 分配的字节数
+};
+
+struct AllocationFrameStats {
+    AllocationCounters counters; // 本帧（所有线程）
+    size_t peakBytes = 0;        // 本帧存活字节数的峰值（只有一个线程分配时准确，多个线程时为上界）
+    size_t liveBytes = 0;        // 帧末的存活字节数
+    size_t imguiRequests = 0;    // 本帧ImGui的分配请求数（arena模式下多数不触及堆）
+};
+
+struct AllocationScopeStats {
+    const char* name = nullptr;
+    AllocationCounters frame;  // 上一帧
+    AllocationCounters total;  // 自ResetScopeTotals以来
+    size_t framePeakBytes = 0; // 上一帧中单次进入作用域期间本线程存活字节数的最大增量
+    size_t peakBytes = 0;      // 同上，自ResetScopeTotals以来的最大值
+};
+
+class AllocationTracker {
+public:
+    // 安装ImGui分配函数，须在创建第一个ImGui上下文之前调用
+    static void InstallImGuiAllocator(bool useArena);
+
+    static AllocationCounters GetTotals(); // 启动以来所有线程的累计值
+    static size_t GetLiveBytes();
+
+    static void BeginFrame();
+    static void EndFrame();                // 汇总本帧和各作用域的统计
+    static const AllocationFrameStats& GetLastFrame();
+
+    static int GetScopeCount();
+    static const AllocationScopeStats& GetScope(int index);
+    static void ResetScopeTotals();
+
+    // 从此后第warmupFrames帧起，有堆分配的帧记为违规
+    static void ExpectZeroSteadyState(int warmupFrames);
+    // 没有违规时返回true，否则error给出违规帧数和第一次违规的明细
+    static bool CheckZeroSteadyState(std::string* error = nullptr);
+
+    static void DrawOverlay(bool* open = nullptr); // ImGui叠加窗口
+};
+
+class AllocationScope {
+public:
+    explicit AllocationScope(const char* name);
+    ~AllocationScope();
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+private:
+    const char* name;
+    AllocationCounters start;
+    size_t startNet;  // 进入时本线程的净存活字节数
+    size_t outerPeak; // 外层作用域到目前为止的峰值
+};
+
+#define ALLOC_CONCAT_IMPL(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_IMPL(a, b)
+#define ALLOC_SCOPE(name) AllocationScope ALLOC_CONCAT(allocScope_, __LINE__)(name)
@@ -0,0 +1,195 @@
+#include "DashboardInstance.h"
+#include "RegionManager.h"
+#include "TaskPool.h"
+#include "Profiler.h"
+#include "AllocationTracker.h"
+#include "ImGuiThreading.h"
+#include <imgui_internal.h>
+
+DashboardInstance::DashboardInstance(const DashboardConfig& config)
+    : config(config) {
+    context = ImGui::CreateContext();
+    buttonContext = MyButtonManager::createContext();
+    messageContext = MessageManager::createContext();
+    regionManager = std::make_unique<RegionManager>();
+    MakeCurrent();
+    // imgui.cpp须与本项目以同样的配置编译，否则并行构建时各线程共用ImGui的全局上下文
+    IM_ASSERT((!SupportsConcurrentFrames() || IsImGuiContextThreadLocal()) &&
+        "imgui.cpp must be compiled with IMGUI_USER_CONFIG=\"ImGuiUserConfig.h\"");
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = this->config.iniFilename.empty() ? nullptr : this->config.iniFilename.c_str();
+    io.DisplaySize = config.displaySize;
+
+    // DPI缩放
+    io.FontGlobalScale = config.contentScale;
+    ImGui::GetStyle().ScaleAllSizes(config.contentScale);
+    ImGui::StyleColorsLight();
+
+    // 构建字体图集（标签字体须在构建之前加入）
+    regionManager->AddLabelFonts(io.Fonts, config.contentScale);
+    unsigned char* pixels = nullptr;
+    int texWidth = 0, texHeight = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &texWidth, &texHeight);
+
+    regionManager->SetWorkerThreads(config.regionThreads);
+    CreateButtonGroups();
+}
+
+DashboardInstance::~DashboardInstance() {
+    // 按钮组在注册表（按钮管理器上下文）之前销毁，区域管理器在ImGui上下文之前销毁
+    regionManager.reset();
+    buttonGroups.clear();
+    MyButtonManager::destroyContext(buttonContext);
+    MessageManager::destroyContext(messageContext);
+    ImGui::DestroyContext(context);
+}
+
+void DashboardInstance::MakeCurrent() {
+    ImGui::SetCurrentContext(context);
+    MyButtonManager::setCurrentContext(buttonContext);
+    MessageManager::setCurrentContext(messageContext);
+}
+
+ImGuiIO& DashboardInstance::GetIO() {
+    return context->IO;
+}
+
+bool DashboardInstance::SupportsConcurrentFrames() {
+    return IMGUI_THREAD_LOCAL_CONTEXT;
+}
+
+void DashboardInstance::CreateButtonGroups() {
+    using ButtonConfig = MyButtonGroup::ButtonConfig;
+
+    // 回调通过当前上下文操作本实例的按钮组和消息
+    buttonGroups.push_back(std::make_unique<MyButtonGroup>("Group1", std::vector<ButtonConfig>{
+        {
+            "Button1", 0.3f, [] {
+            MyButtonManager::deferUIUpdate([] {
+                MessageManager::addMessage("Callback: Group1-Button1");
+            });
+        }},
+        {
+            "Button2", 0.5f, [] {
+            MyButtonManager::deferUIUpdate([] {
+                MessageManager::addMessage("Callback: Group1-Button2 - Changing other groups");
+            });
+        }},
+        {
+            "Button3", 0.2f, [] {
+            MyButtonManager::deferUIUpdate([] {
+                MessageManager::addMessage("Callback: Group1-Button3 - Changing other groups");
+            });
+            MyButtonManager::setHighlight("Group2", "B");
+            MyButtonManager::clickButton("Group3", "X");
+        }}
+    }));
+
+    buttonGroups.push_back(std::make_unique<MyButtonGroup>("Group2", std::vector<ButtonConfig>{
+        { "A", 0.4f, [] {} },
+        { "B", 0.3f, [] {} },
+        { "C", 0.3f, [] {} }
+    }));
+
+    buttonGroups.push_back(std::make_unique<MyButtonGroup>("Group3", std::vector<ButtonConfig>{
+        { "X", 0.6f, [] {} },
+        { "Y", 0.4f, [] {} }
+    }));
+
+    // 注册到管理器
+    for (auto& group : buttonGroups) {
+        MyButtonManager::addGroup(group.get());
+    }
+
+    // 设置初始高亮
+    MyButtonManager::setHighlight("Group1", "Button1");
+    MyButtonManager::setHighlight("Group2", "A");
+    MyButtonManager::setHighlight("Group3", "Y");
+}
+
+void DashboardInstance::DrawButtonGroups() {
+    for (auto& group : buttonGroups) {
+        group->render();
+    }
+
+    // 显示调试信息
+    ImGui::Separator();
+    ImGui::Text("Interaction Example:");
+    if (ImGui::Button("Programmatically click Group1-Button2")) {
+        MyButtonManager::clickButton("Group1", "Button2");
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Highlight Group2-C")) {
+        MyButtonManager::setHighlight("Group2", "C");
+    }
+
+    // 处理本帧的延迟回调
+    MyButtonManager::processDeferredUpdates();
+
+    // 渲染所有消息
+    ImGui::Separator();
+    ImGui::Text("Messages:");
+    MessageManager::renderMessages();
+}
+
+void DashboardInstance::DrawRegions() {
+    if (ImGui::Button("Reload Config") || ImGui::IsKeyPressed(ImGuiKey_F5, false)) {
+        regionManager->ReloadConfig();
+    }
+    ImGui::SameLine();
+    ImGui::Text("Press F5 to reload layout from file");
+    regionManager->DrawUI();
+}
+
+void DashboardInstance::DrawUI() {
+    PROFILE_SCOPE("DashboardInstance::DrawUI");
+    ALLOC_SCOPE("DashboardInstance::DrawUI");
+
+    ImGui::SetNextWindowPos(ImVec2(0, 0));
+    ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+
+    ImGui::Begin(config.title.c_str(), nullptr,
+        ImGuiWindowFlags_NoTitleBar |
+        ImGuiWindowFlags_NoResize |
+        ImGuiWindowFlags_NoMove |
+        ImGuiWindowFlags_NoCollapse |
+        ImGuiWindowFlags_NoScrollbar);
+
+    if (config.showRegions) {
+        DrawRegions();
+    }
+    DrawButtonGroups();
+
+    ImGui::End();
+}
+
+void DashboardInstance::BuildFrame(float deltaTime) {
+    // 线程池中的线程可能轮流构建不同的实例，结束后恢复原来的当前上下文
+    ImGuiContext* previousContext = ImGui::GetCurrentContext();
+    MyButtonManager::Context* previousButtons = MyButtonManager::getCurrentContext();
+    MessageManager::Context* previousMessages = MessageManager::getCurrentContext();
+    MakeCurrent();
+
+    ImGui::GetIO().DeltaTime = deltaTime > 0.0f ? deltaTime : 1.0f / 60.0f;
+    ImGui::NewFrame();
+    DrawUI();
+    ImGui::Render();
+    drawData = ImGui::GetDrawData();
+
+    ImGui::SetCurrentContext(previousContext);
+    MyButtonManager::setCurrentContext(previousButtons);
+    MessageManager::setCurrentContext(previousMessages);
+}
+
+void BuildDashboardFrames(const std::vector<DashboardInstance*>& instances, TaskPool* pool, float deltaTime) {
+    if (pool && DashboardInstance::SupportsConcurrentFrames()) {
+        pool->ParallelFor(static_cast<int>(instances.size()), [&](int index, int) {
+            instances[index]->BuildFrame(deltaTime);
+        });
+        return;
+    }
+    for (DashboardInstance* instance : instances) {
+        instance->BuildFrame(deltaTime);
+    }
+}
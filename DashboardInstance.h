@@ -0,0 +1,69 @@
+#pragma once
+
+#include <imgui.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MyButtonGroup.h"
+#include "MessageManager.h"
+
+class RegionManager;
+class TaskPool;
+
+struct DashboardConfig {
+    std::string title = "Hierarchical Region Layout"; // 全屏窗口的名称
+    std::string iniFilename;      // ImGui设置文件，为空时不保存
+    ImVec2 displaySize{ 1280.0f, 720.0f };
+    float contentScale = 1.0f;    // DPI缩放（字体和样式）
+    bool showRegions = false;     // 是否绘制区域图
+    int regionThreads = 1;        // 区域布局/细分线程数（实例并行构建时通常为1）
+};
+
+// 仪表盘实例：拥有自己的ImGui上下文（含字体图集）、区域管理器、按钮组和消息日志。
+// 使用时把这些设为调用线程的当前上下文，多个实例可以在不同线程上同时构建帧（须以ImGuiUserConfig.h编译），
+// 构建完成后由调用方渲染或合成各实例的ImDrawData。
+// 字体图集在构造时构建，纹理由渲染方创建（GPU后端在第一帧创建，CPU渲染调用CreateFontsTexture）。
+class DashboardInstance {
+public:
+    explicit DashboardInstance(const DashboardConfig& config); // 构造后调用线程的当前上下文为该实例
+    ~DashboardInstance();
+    DashboardInstance(const DashboardInstance&) = delete;
+    DashboardInstance& operator=(const DashboardInstance&) = delete;
+
+    // 设置调用线程的当前ImGui、按钮管理器和消息上下文
+    void MakeCurrent();
+
+    // 绘制界面内容，在NewFrame和Render之间调用（实例须为当前上下文）
+    void DrawUI();
+
+    // 无平台后端地构建一帧：MakeCurrent -> NewFrame -> DrawUI -> Render，之后恢复调用线程原来的当前上下文
+    // 输入事件须事先在该实例为当前上下文时加入GetIO()
+    void BuildFrame(float deltaTime);
+    ImDrawData* GetDrawData() const { return drawData; } // 最近一次BuildFrame的结果
+
+    ImGuiContext* GetContext() const { return context; }
+    // 按钮管理器上下文，其他线程用它向本实例投递延迟回调（MyButtonManager::deferUIUpdate）
+    MyButtonManager::Context* GetButtonContext() const { return buttonContext; }
+    ImGuiIO& GetIO();
+    RegionManager& GetRegionManager() { return *regionManager; }
+    const DashboardConfig& GetConfig() const { return config; }
+
+    // ImGui是否以线程局部的当前上下文编译（否则只能依次构建，见ImGuiThreading.h）
+    static bool SupportsConcurrentFrames();
+
+private:
+    void CreateButtonGroups();
+    void DrawButtonGroups();
+    void DrawRegions();
+
+    DashboardConfig config;
+    ImGuiContext* context = nullptr;
+    MyButtonManager::Context* buttonContext = nullptr;
+    MessageManager::Context* messageContext = nullptr;
+    std::unique_ptr<RegionManager> regionManager;
+    std::vector<std::unique_ptr<MyButtonGroup>> buttonGroups;
+    ImDrawData* drawData = nullptr;
+};
+
+// 构建所有实例的一帧：pool非空且支持并发时在线程池上并行构建，否则依次构建
+void BuildDashboardFrames(const std::vector<DashboardInstance*>& instances, TaskPool* pool, float deltaTime);
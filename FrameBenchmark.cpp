@@ -0,0 +1,657 @@
+// FrameBenchmark.cpp
+// 无窗口的帧基准测试：只创建ImGui上下文（不需要平台/渲染后端和GPU），
+// 合成区域树和按钮组，用脚本化的鼠标输入驱动 NewFrame / UI / Render，
+// 输出各阶段p50/p99耗时、顶点数和每帧堆分配次数。
+// 最后连续程序化点击按钮（回调中再延迟入队），检查这一过程没有任何堆分配，有则返回非0。
+// --raster N 用N个线程的CPU渲染后端光栅化每帧（计入Raster阶段），--png 把最后一帧写成PNG。
+// --threads N 用N个线程并行布局和细分区域（0表示全部硬件线程，区域较少时仍为串行）。
+// --weighted 1 给合成区域设置不等的权重和最小尺寸（走加权/约束布局，默认等分）。
+// --snapshot FILE 把合成区域树写成二进制快照再映射加载，输出构建/写出/加载耗时，之后使用加载的树。
+// --arena 1 ImGui的内部缓冲区使用块池分配；--zero-alloc 1 计时帧中有任何堆分配时返回非0。
+// --dashboards N 改为测N个仪表盘实例（各自的ImGui上下文和区域树，按网格平铺在W x H内）：
+//   用--threads个线程的线程池并行构建各实例的帧，之后依次光栅化并合成（--raster/--png）。
+// --live N 由一个生产者线程以每秒N次的速率更新叶子区域的实时值（数值、状态文字和状态色），
+//   输出每帧取得新值的区域数和实际的更新/发布速率。
+// --verify-serial 1 计时之前先用串行和--threads个线程各构建一组帧，逐帧比较绘制数据的校验和，
+//   并行结果与串行不完全相同时返回非0。
+//
+
+// 用法: FrameBenchmark [--frames N] [--warmup N] [--rows N] [--depth N] [--breadth N]
+//                      [--groups N] [--buttons N] [--width W] [--height H] [--clicks N]
+//                      [--raster N] [--png FILE] [--threads N] [--weighted 0|1]
+//                      [--snapshot FILE] [--arena 0|1] [--zero-alloc 0|1] [--dashboards N] [--live N]
+//                      [--verify-serial 0|1]
+
+#include "RegionManager.h"
+#include "MyButtonGroup.h"
+#include "SoftwareRenderer.h"
+#include "AllocationTracker.h"
+#include "DashboardInstance.h"
+#include "TaskPool.h"
+#include "RegionLiveData.h"
+#include "InputRecording.h"
+#include <imgui.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////// 参数
+struct BenchConfig {
+    int frames = 600;     // 计时帧数
+    int warmup = 60;      // 预热帧数
+    int rows = 50;        // 行数
+    int depth = 1;        // 行内组的嵌套层数（0表示叶子直接在行内）
+    int breadth = 20;     // 每个行/组的子区域数
+    int groups = 20;      // 按钮组数量
+    int buttons = 5;      // 每组按钮数
+    float width = 1920.0f;
+    float height = 1080.0f;
+    int clicks = 10000;   // 堆分配检查中的程序化点击次数
+    int raster = 0;       // CPU光栅化线程数，0表示不光栅化
+    std::string png;      // 最后一帧的输出文件（需要光栅化）
+    int threads = 1;      // 区域布局/细分线程数，0表示全部硬件线程
+    bool weighted = false; // 合成区域使用不等权重和最小尺寸
+    std::string snapshot; // 快照文件，非空时经快照加载区域树
+    bool arena = false;   // ImGui使用块池分配
+    bool zeroAlloc = false; // 要求计时帧零堆分配
+    int dashboards = 0;   // 仪表盘实例数，0表示单上下文基准
+    int live = 0;         // 实时数据每秒更新次数，0表示不启用
+    bool verifySerial = false; // 检查并行构建的帧与串行逐位相同
+};
+
+static bool ParseArgs(int argc, char** argv, BenchConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "missing value for %s\n", arg);
+            return false;
+        }
+        const char* value = argv[++i];
+        if (!std::strcmp(arg, "--frames")) config.frames = std::atoi(value);
+        else if (!std::strcmp(arg, "--warmup")) config.warmup = std::atoi(value);
+        else if (!std::strcmp(arg, "--rows")) config.rows = std::atoi(value);
+        else if (!std::strcmp(arg, "--depth")) config.depth = std::atoi(value);
+        else if (!std::strcmp(arg, "--breadth")) config.breadth = std::atoi(value);
+        else if (!std::strcmp(arg, "--groups")) config.groups = std::atoi(value);
+        else if (!std::strcmp(arg, "--buttons")) config.buttons = std::atoi(value);
+        else if (!std::strcmp(arg, "--width")) config.width = static_cast<float>(std::atof(value));
+        else if (!std::strcmp(arg, "--height")) config.height = static_cast<float>(std::atof(value));
+        else if (!std::strcmp(arg, "--clicks")) config.clicks = std::atoi(value);
+        else if (!std::strcmp(arg, "--raster")) config.raster = std::atoi(value);
+        else if (!std::strcmp(arg, "--png")) config.png = value;
+        else if (!std::strcmp(arg, "--threads")) config.threads = std::atoi(value);
+        else if (!std::strcmp(arg, "--weighted")) config.weighted = std::atoi(value) != 0;
+        else if (!std::strcmp(arg, "--snapshot")) config.snapshot = value;
+        else if (!std::strcmp(arg, "--arena")) config.arena = std::atoi(value) != 0;
+        else if (!std::strcmp(arg, "--zero-alloc")) config.zeroAlloc = std::atoi(value) != 0;
+        else if (!std::strcmp(arg, "--dashboards")) config.dashboards = std::atoi(value);
+        else if (!std::strcmp(arg, "--live")) config.live = std::atoi(value);
+        else if (!std::strcmp(arg, "--verify-serial")) config.verifySerial = std::atoi(value) != 0;
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg);
+            return false;
+        }
+    }
+    return config.frames > 0 && config.rows > 0 && config.breadth > 0 && config.depth >= 0 && config.clicks >= 0 && config.raster >= 0 && config.threads >= 0 && config.dashboards >= 0 && config.live >= 0;
+}
+
+///////////////////////////////////////////////////////////////////////////// 合成数据
+static void AddSyntheticChildren(RegionTree& tree, IDGenerator& idGen, RegionHandle parent,
+    int depth, int breadth, bool weighted, int& groupCounter) {
+    for (int i = 0; i < breadth; i++) {
+        RegionHandle child;
+        if (depth == 0) {
+            const std::string name = "L" + std::to_string(i);
+            child = tree.AddRegion(parent, REGION_LEAF, idGen.GetID(name), name, tree.groupId[parent]);
+        }
+        else {
+            const std::string name = "G" + std::to_string(groupCounter++);
+            child = tree.AddRegion(parent, REGION_GROUP, idGen.GetID(name), name, name);
+            AddSyntheticChildren(tree, idGen, child, depth - 1, breadth, weighted, groupCounter);
+        }
+        if (weighted) {
+            // 权重1~3，每5个子区域中有一个带最小尺寸
+            RegionConstraint constraint;
+            constraint.weight = 1.0f + (i % 3);
+            if (i % 5 == 0) constraint.minSize = 8.0f;
+            tree.SetConstraint(child, constraint);
+        }
+    }
+}
+
+static RegionTree BuildSyntheticTree(const BenchConfig& config) {
+    RegionTree tree;
+    IDGenerator idGen;
+    RegionHandle root = tree.AddRegion(INVALID_REGION, REGION_ROOT, "root", "Root");
+    int groupCounter = 0;
+    for (int r = 0; r < config.rows; r++) {
+        const std::string name = "Row" + std::to_string(r);
+        RegionHandle row = tree.AddRegion(root, REGION_ROW, idGen.GetID(name), name);
+        AddSyntheticChildren(tree, idGen, row, config.depth, config.breadth, config.weighted, groupCounter);
+    }
+    tree.BuildMembership();
+    return tree;
+}
+
+static std::atomic<size_t> g_deferredRuns{ 0 };
+
+static std::vector<std::unique_ptr<MyButtonGroup>> BuildButtonGroups(const BenchConfig& config) {
+    std::vector<std::unique_ptr<MyButtonGroup>> groups;
+    for (int g = 0; g < config.groups; g++) {
+        std::vector<MyButtonGroup::ButtonConfig> buttons;
+        for (int b = 0; b < config.buttons; b++) {
+            // 与演示程序相同的嵌套回调：点击时把带捕获的更新延迟到帧内执行
+            buttons.emplace_back("B" + std::to_string(b), 1.0f + (b % 3), [g, b] {
+                MyButtonManager::deferUIUpdate([g, b] {
+                    g_deferredRuns.fetch_add(static_cast<size_t>(g + b) + 1, std::memory_order_relaxed);
+                });
+            });
+        }
+        groups.push_back(std::make_unique<MyButtonGroup>("BenchGroup" + std::to_string(g), buttons));
+        MyButtonManager::addGroup(groups.back().get());
+    }
+    return groups;
+}
+
+///////////////////////////////////////////////////////////////////////////// 实时数据
+// 模拟遥测源：每毫秒按速率补齐应有的更新数后发布一次，数值、状态文字和状态色轮流更新
+static void RunLiveProducer(RegionLiveData& data, const std::vector<std::string>& regionIds, int rate,
+    const std::atomic<bool>& stop, std::atomic<bool>& ready) {
+    std::vector<int> channels;
+    for (const std::string& id : regionIds) channels.push_back(data.RegisterChannel(id));
+    data.Publish();
+    ready.store(true, std::memory_order_release);
+
+    static const char* const STATUS_TEXT[] = { "OK", "WARN", "FAIL" };
+    static const ImU32 STATUS_COLOR[] = { IM_COL32(170, 220, 170, 255), IM_COL32(240, 220, 130, 255), IM_COL32(240, 150, 140, 255) };
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    unsigned long long sent = 0;
+    unsigned int random = 12345;
+    while (!stop.load(std::memory_order_relaxed)) {
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        const unsigned long long target = static_cast<unsigned long long>(seconds * rate);
+        for (; sent < target; sent++) {
+            random = random * 1664525u + 1013904223u;
+            const int channel = channels[(random >> 8) % channels.size()];
+            const int status = static_cast<int>(random >> 28) % 3;
+            switch (sent % 3) {
+            case 0: data.SetNumber(channel, static_cast<double>(random % 10000) * 0.01); break;
+            case 1: data.SetText(channel, STATUS_TEXT[status]); break;
+            default: data.SetStatusColor(channel, STATUS_COLOR[status]); break;
+            }
+        }
+        data.Publish();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////// 统计
+struct PhaseSamples {
+    const char* name;
+    std::vector<double> values;
+};
+
+static double Percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    return values[index];
+}
+
+static void PrintRow(const PhaseSamples& samples, const char* unit) {
+    double sum = 0.0;
+    for (double v : samples.values) sum += v;
+    const double mean = samples.values.empty() ? 0.0 : sum / samples.values.size();
+    std::printf("%-14s %12.3f %12.3f %12.3f %12.3f  %s\n", samples.name,
+        Percentile(samples.values, 0.50), Percentile(samples.values, 0.99),
+        mean, samples.values.empty() ? 0.0 : *std::max_element(samples.values.begin(), samples.values.end()),
+        unit);
+}
+
+///////////////////////////////////////////////////////////////////////////// 并行一致性
+// 在独立的上下文中用同一棵合成树和与计时帧相同的脚本化鼠标输入构建frames帧，返回各帧绘制数据的校验和
+static std::vector<uint64_t> ChecksumFrames(const BenchConfig& config, int threads, int frames) {
+    ImGuiContext* context = ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(config.width, config.height);
+    io.DeltaTime = 1.0f / 60.0f;
+    std::vector<uint64_t> checksums;
+    {
+        RegionManager regionManager;
+        regionManager.AddLabelFonts(io.Fonts, 1.0f);
+        unsigned char* pixels = nullptr;
+        int texWidth = 0, texHeight = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &texWidth, &texHeight);
+        io.Fonts->SetTexID(reinterpret_cast<ImTextureID>(static_cast<intptr_t>(1)));
+        ImGui::StyleColorsLight();
+        regionManager.SetWorkerThreads(threads);
+        regionManager.SetTree(BuildSyntheticTree(config));
+
+        for (int frame = 0; frame < frames; frame++) {
+            const float t = static_cast<float>(frame % 240) / 240.0f;
+            io.AddMousePosEvent(config.width * t, config.height * (0.15f + 0.8f * t));
+            if ((frame % 30) == 0) io.AddMouseButtonEvent(ImGuiMouseButton_Left, true);
+            if ((frame % 30) == 1) io.AddMouseButtonEvent(ImGuiMouseButton_Left, false);
+
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos(ImVec2(0, 0));
+            ImGui::SetNextWindowSize(io.DisplaySize);
+            ImGui::Begin("Benchmark", nullptr,
+                ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove |
+                ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoScrollbar);
+            regionManager.DrawUI();
+            ImGui::End();
+            ImGui::Render();
+            checksums.push_back(ChecksumDrawData(ImGui::GetDrawData()));
+        }
+    }
+    ImGui::DestroyContext(context);
+    return checksums;
+}
+
+// 并行布局和细分的结果必须与串行逐位相同（顶点、索引和命令划分）
+static bool VerifyParallelMatchesSerial(const BenchConfig& config) {
+    const int frames = std::min(config.warmup + config.frames, 60);
+    const std::vector<uint64_t> serial = ChecksumFrames(config, 1, frames);
+    const std::vector<uint64_t> parallel = ChecksumFrames(config, config.threads, frames);
+    for (int frame = 0; frame < frames; frame++) {
+        if (serial[frame] != parallel[frame]) {
+            std::printf("parallel output differs from serial at frame %d (%016llx != %016llx)\n", frame,
+                static_cast<unsigned long long>(parallel[frame]), static_cast<unsigned long long>(serial[frame]));
+            return false;
+        }
+    }
+    std::printf("parallel output: identical to serial over %d frames\n", frames);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////// 多实例
+// 每个实例一个网格单元大小的显示区域，帧在线程池上并行构建，光栅化后拷贝到合成图像的对应位置
+static int RunDashboards(BenchConfig config) {
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+
+    const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(config.dashboards))));
+    const int rows = (config.dashboards + columns - 1) / columns;
+    const int tileWidth = static_cast<int>(config.width) / columns;
+    const int tileHeight = static_cast<int>(config.height) / rows;
+    if (!config.png.empty() && config.raster == 0) {
+        config.raster = 1;
+    }
+
+    IMGUI_CHECKVERSION();
+    AllocationTracker::InstallImGuiAllocator(config.arena);
+    std::unique_ptr<SoftwareRenderer> rasterizer;
+    if (config.raster > 0) {
+        rasterizer = std::make_unique<SoftwareRenderer>(config.raster);
+    }
+
+    std::vector<std::unique_ptr<DashboardInstance>> instances;
+    std::vector<DashboardInstance*> instancePointers;
+    size_t regionCount = 0;
+    for (int i = 0; i < config.dashboards; i++) {
+        DashboardConfig dashboardConfig;
+        dashboardConfig.title = "Dashboard" + std::to_string(i);
+        dashboardConfig.displaySize = ImVec2(static_cast<float>(tileWidth), static_cast<float>(tileHeight));
+        dashboardConfig.showRegions = true;
+        dashboardConfig.regionThreads = 1;
+        instances.push_back(std::make_unique<DashboardInstance>(dashboardConfig)); // 构造后为当前上下文
+        if (rasterizer) {
+            rasterizer->CreateFontsTexture();
+        }
+        else {
+            ImGui::GetIO().Fonts->SetTexID(reinterpret_cast<ImTextureID>(static_cast<intptr_t>(1)));
+        }
+        instances.back()->GetRegionManager().SetTree(BuildSyntheticTree(config));
+        regionCount = instances.back()->GetRegionManager().GetTree().Size();
+        instancePointers.push_back(instances.back().get());
+    }
+
+    // threads为0时使用全部硬件线程；为1时不创建线程池（串行基线）
+    std::unique_ptr<TaskPool> pool;
+    if (config.threads != 1) {
+        pool = std::make_unique<TaskPool>(config.threads);
+    }
+    const bool concurrent = pool && DashboardInstance::SupportsConcurrentFrames();
+    std::printf("dashboards: %d (%d x %d, %d x %d px)  regions: %zu each  build threads: %d%s  frames: %d (+%d warmup)\n",
+        config.dashboards, columns, rows, tileWidth, tileHeight, regionCount,
+        pool ? pool->GetThreadCount() : 1, pool && !concurrent ? " (serial: ImGui built without ImGuiUserConfig.h)" : "",
+        config.frames, config.warmup);
+
+    SoftwareImage tile, image;
+    if (rasterizer) {
+        tile.Resize(tileWidth, tileHeight);
+        image.Resize(tileWidth * columns, tileHeight * rows);
+        image.Clear(IM_COL32(115, 140, 153, 255));
+    }
+
+    PhaseSamples buildMs{ "Build", {} }, rasterMs{ "Raster", {} }, totalMs{ "Frame", {} };
+    PhaseSamples vertices{ "Vertices", {} }, allocations{ "Allocations", {} };
+    const int totalFrames = config.warmup + config.frames;
+    for (int frame = 0; frame < totalFrames; frame++) {
+        // 与单上下文基准相同的脚本化输入，各实例错开相位
+        for (int i = 0; i < config.dashboards; i++) {
+            const int phase = frame + i * 17;
+            const float t = static_cast<float>(phase % 240) / 240.0f;
+            instances[i]->MakeCurrent();
+            ImGuiIO& io = ImGui::GetIO();
+            io.AddMousePosEvent(tileWidth * t, tileHeight * (0.15f + 0.8f * t));
+            if ((phase % 30) == 0) io.AddMouseButtonEvent(ImGuiMouseButton_Left, true);
+            if ((phase % 30) == 1) io.AddMouseButtonEvent(ImGuiMouseButton_Left, false);
+        }
+
+        AllocationTracker::BeginFrame();
+        const Clock::time_point t0 = Clock::now();
+        BuildDashboardFrames(instancePointers, pool.get(), 1.0f / 60.0f);
+        const Clock::time_point t1 = Clock::now();
+        size_t frameVertices = 0;
+        for (int i = 0; i < config.dashboards; i++) {
+            const ImDrawData* drawData = instances[i]->GetDrawData();
+            frameVertices += static_cast<size_t>(drawData->TotalVtxCount);
+            if (!rasterizer) continue;
+            tile.Clear(IM_COL32(115, 140, 153, 255));
+            rasterizer->Render(drawData, tile);
+            const int originX = (i % columns) * tileWidth;
+            const int originY = (i / columns) * tileHeight;
+            for (int y = 0; y < tileHeight; y++) {
+                std::memcpy(&image.pixels[static_cast<size_t>(originY + y) * image.width + originX],
+                    &tile.pixels[static_cast<size_t>(y) * tileWidth], tileWidth * sizeof(uint32_t));
+            }
+        }
+        const Clock::time_point t2 = Clock::now();
+        AllocationTracker::EndFrame();
+
+        if (frame < config.warmup) continue;
+        buildMs.values.push_back(elapsedMs(t0, t1));
+        rasterMs.values.push_back(elapsedMs(t1, t2));
+        totalMs.values.push_back(elapsedMs(t0, t2));
+        vertices.values.push_back(static_cast<double>(frameVertices));
+        allocations.values.push_back(static_cast<double>(AllocationTracker::GetLastFrame().counters.allocations));
+    }
+
+    if (!config.png.empty()) {
+        if (SoftwareRenderer::WritePNG(config.png, image)) {
+            std::printf("last frame written to %s\n", config.png.c_str());
+        }
+        else {
+            std::fprintf(stderr, "failed to write %s\n", config.png.c_str());
+        }
+    }
+
+    std::printf("%-14s %12s %12s %12s %12s\n", "phase", "p50", "p99", "mean", "max");
+    PrintRow(buildMs, "ms");
+    if (rasterizer) PrintRow(rasterMs, "ms");
+    PrintRow(totalMs, "ms");
+    PrintRow(vertices, "vertices/frame");
+    PrintRow(allocations, "allocs/frame");
+
+    instancePointers.clear();
+    instances.clear();
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////// 主流程
+int main(int argc, char** argv) {
+    BenchConfig config;
+    if (!ParseArgs(argc, argv, config)) {
+        std::fprintf(stderr, "usage: FrameBenchmark [--frames N] [--warmup N] [--rows N] [--depth N] [--breadth N]"
+            " [--groups N] [--buttons N] [--width W] [--height H] [--clicks N] [--raster N] [--png FILE] [--threads N]"
+            " [--weighted 0|1] [--snapshot FILE] [--arena 0|1] [--zero-alloc 0|1] [--dashboards N] [--live N]"
+            " [--verify-serial 0|1]\n");
+        return 1;
+    }
+    if (config.dashboards > 0) {
+        return RunDashboards(config);
+    }
+
+    // 无后端的ImGui上下文：只需构建字体图集
+    IMGUI_CHECKVERSION();
+    AllocationTracker::InstallImGuiAllocator(config.arena);
+    if (config.verifySerial && config.threads != 1 && !VerifyParallelMatchesSerial(config)) {
+        return 4;
+    }
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(config.width, config.height);
+    io.DeltaTime = 1.0f / 60.0f;
+    if (!config.png.empty() && config.raster == 0) {
+        config.raster = 1;
+    }
+    RegionManager regionManager;
+    regionManager.AddLabelFonts(io.Fonts, 1.0f);
+    std::unique_ptr<SoftwareRenderer> rasterizer;
+    SoftwareImage image;
+    if (config.raster > 0) {
+        rasterizer = std::make_unique<SoftwareRenderer>(config.raster);
+        rasterizer->CreateFontsTexture();
+        image.Resize(static_cast<int>(config.width), static_cast<int>(config.height));
+    }
+    else {
+        unsigned char* pixels = nullptr;
+        int texWidth = 0, texHeight = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &texWidth, &texHeight);
+        io.Fonts->SetTexID(reinterpret_cast<ImTextureID>(static_cast<intptr_t>(1)));
+    }
+    ImGui::StyleColorsLight();
+
+    regionManager.SetWorkerThreads(config.threads);
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+
+    const Clock::time_point buildStart = Clock::now();
+    regionManager.SetTree(BuildSyntheticTree(config));
+    if (!config.snapshot.empty()) {
+        // 对比从头构建与写出/映射加载快照的耗时
+        const Clock::time_point writeStart = Clock::now();
+        std::string error;
+        if (!regionManager.SaveSnapshot(config.snapshot, &error)) {
+            std::fprintf(stderr, "snapshot: %s\n", error.c_str());
+            return 1;
+        }
+        const Clock::time_point loadStart = Clock::now();
+        if (!regionManager.LoadSnapshot(config.snapshot, &error)) {
+            std::fprintf(stderr, "snapshot: %s\n", error.c_str());
+            return 1;
+        }
+        const Clock::time_point loadEnd = Clock::now();
+        std::printf("snapshot: build %.2f ms  write %.2f ms  load %.2f ms\n",
+            elapsedMs(buildStart, writeStart), elapsedMs(writeStart, loadStart), elapsedMs(loadStart, loadEnd));
+    }
+    std::vector<std::unique_ptr<MyButtonGroup>> buttonGroups = BuildButtonGroups(config);
+
+    // 实时数据源绑定所有叶子区域，通道注册完成后才开始预热（注册时的分配不计入稳态）
+    std::unique_ptr<RegionLiveData> liveData;
+    std::vector<std::string> liveIds;
+    std::atomic<bool> liveStop{ false }, liveReady{ false };
+    std::thread liveProducer;
+    if (config.live > 0) {
+        const RegionTree& tree = regionManager.GetTree();
+        for (RegionHandle region = 0; region < static_cast<RegionHandle>(tree.Size()); region++) {
+            if (tree.IsLeaf(region)) liveIds.emplace_back(tree.id[region]);
+        }
+        liveData = std::make_unique<RegionLiveData>(static_cast<int>(liveIds.size()));
+        regionManager.AddLiveData(liveData.get());
+        liveProducer = std::thread(RunLiveProducer, std::ref(*liveData), std::cref(liveIds), config.live,
+            std::cref(liveStop), std::ref(liveReady));
+        while (!liveReady.load(std::memory_order_acquire)) std::this_thread::yield();
+    }
+
+    std::printf("regions: %zu  button groups: %d x %d  frames: %d (+%d warmup)\n",
+        regionManager.GetTree().Size(), config.groups, config.buttons, config.frames, config.warmup);
+
+    PhaseSamples newFrameMs{ "NewFrame", {} }, uiMs{ "UI", {} }, renderMs{ "Render", {} }, rasterMs{ "Raster", {} }, totalMs{ "Frame", {} };
+    PhaseSamples vertices{ "Vertices", {} }, allocations{ "Allocations", {} }, allocatedKB{ "AllocatedKB", {} };
+    PhaseSamples peakKB{ "PeakKB", {} }, measured{ "Measured", {} }, liveChanged{ "LiveChanged", {} };
+    // 重复帧是稳态：预热之后每帧都不应有堆分配
+    AllocationTracker::ExpectZeroSteadyState(config.warmup);
+
+    const int totalFrames = config.warmup + config.frames;
+    Clock::time_point timedStart = Clock::now();
+    unsigned long long liveUpdatesStart = 0, livePublishesStart = 0;
+    for (int frame = 0; frame < totalFrames; frame++) {
+        if (frame == config.warmup && liveData) {
+            timedStart = Clock::now();
+            liveUpdatesStart = liveData->GetUpdateCount();
+            livePublishesStart = liveData->GetPublishCount();
+        }
+
+        // 脚本化输入：鼠标沿对角线扫过，每30帧点击一次
+        const float t = static_cast<float>(frame % 240) / 240.0f;
+        io.AddMousePosEvent(config.width * t, config.height * (0.15f + 0.8f * t));
+        const bool pressed = (frame % 30) == 0;
+        const bool released = (frame % 30) == 1;
+        if (pressed) io.AddMouseButtonEvent(ImGuiMouseButton_Left, true);
+        if (released) io.AddMouseButtonEvent(ImGuiMouseButton_Left, false);
+
+        // 程序化点击按钮组
+        if (!buttonGroups.empty() && config.buttons > 0 && (frame % 10) == 0) {
+            const int g = (frame / 10) % config.groups;
+            MyButtonManager::clickButton("BenchGroup" + std::to_string(g), "B" + std::to_string(frame % config.buttons));
+        }
+
+        AllocationTracker::BeginFrame();
+        const Clock::time_point t0 = Clock::now();
+        ImGui::NewFrame();
+        const Clock::time_point t1 = Clock::now();
+
+        // 与DrawMainUI相同的窗口结构
+        ImGui::SetNextWindowPos(ImVec2(0, 0));
+        ImGui::SetNextWindowSize(io.DisplaySize);
+        ImGui::Begin("Benchmark", nullptr,
+            ImGuiWindowFlags_NoTitleBar |
+            ImGuiWindowFlags_NoResize |
+            ImGuiWindowFlags_NoMove |
+            ImGuiWindowFlags_NoCollapse |
+            ImGuiWindowFlags_NoScrollbar);
+        for (auto& group : buttonGroups) {
+            group->render();
+        }
+        MyButtonManager::processDeferredUpdates();
+        regionManager.DrawUI();
+        ImGui::End();
+        const Clock::time_point t2 = Clock::now();
+
+        ImGui::Render();
+        const Clock::time_point t3 = Clock::now();
+        if (rasterizer) {
+            image.Clear(IM_COL32(115, 140, 153, 255)); // 与演示程序的glClearColor相同
+            rasterizer->Render(ImGui::GetDrawData(), image);
+        }
+        const Clock::time_point t4 = Clock::now();
+        AllocationTracker::EndFrame();
+
+        if (frame + 1 == config.warmup) AllocationTracker::ResetScopeTotals();
+        if (frame < config.warmup) continue;
+        newFrameMs.values.push_back(elapsedMs(t0, t1));
+        uiMs.values.push_back(elapsedMs(t1, t2));
+        renderMs.values.push_back(elapsedMs(t2, t3));
+        rasterMs.values.push_back(elapsedMs(t3, t4));
+        totalMs.values.push_back(elapsedMs(t0, t4));
+        vertices.values.push_back(static_cast<double>(ImGui::GetDrawData()->TotalVtxCount));
+        const AllocationFrameStats& heap = AllocationTracker::GetLastFrame();
+        allocations.values.push_back(static_cast<double>(heap.counters.allocations));
+        allocatedKB.values.push_back(heap.counters.bytes / 1024.0);
+        peakKB.values.push_back(heap.peakBytes / 1024.0);
+        measured.values.push_back(static_cast<double>(regionManager.GetGeometryCache().GetMeasuredCount()));
+        liveChanged.values.push_back(static_cast<double>(regionManager.GetLiveChangedCount()));
+    }
+
+    if (liveData) {
+        const double seconds = std::chrono::duration<double>(Clock::now() - timedStart).count();
+        liveStop.store(true, std::memory_order_relaxed);
+        liveProducer.join();
+        std::printf("live: %zu channels  %.0f updates/s  %.0f publishes/s\n", liveIds.size(),
+            (liveData->GetUpdateCount() - liveUpdatesStart) / seconds,
+            (liveData->GetPublishCount() - livePublishesStart) / seconds);
+        regionManager.RemoveLiveData(liveData.get());
+    }
+
+    if (!config.png.empty()) {
+        if (SoftwareRenderer::WritePNG(config.png, image)) {
+            std::printf("last frame written to %s\n", config.png.c_str());
+        }
+        else {
+            std::fprintf(stderr, "failed to write %s\n", config.png.c_str());
+        }
+    }
+
+    std::printf("%-14s %12s %12s %12s %12s\n", "phase", "p50", "p99", "mean", "max");
+    PrintRow(newFrameMs, "ms");
+    PrintRow(uiMs, "ms");
+    PrintRow(renderMs, "ms");
+    if (rasterizer) PrintRow(rasterMs, "ms");
+    PrintRow(totalMs, "ms");
+    PrintRow(vertices, "vertices/frame");
+    PrintRow(allocations, "allocs/frame");
+    PrintRow(allocatedKB, "KB/frame");
+    PrintRow(peakKB, "KB live");
+    PrintRow(measured, "labels/frame");
+    if (liveData) PrintRow(liveChanged, "regions/frame");
+
+    // 各作用域在计时帧中的平均分配（包含嵌套作用域，只统计主线程）
+    std::printf("%-40s %12s %12s %12s\n", "scope", "allocs/frame", "KB/frame", "peak KB");
+    for (int i = 0; i < AllocationTracker::GetScopeCount(); i++) {
+        const AllocationScopeStats& scope = AllocationTracker::GetScope(i);
+        std::printf("%-40s %12.2f %12.2f %12.2f\n", scope.name,
+            static_cast<double>(scope.total.allocations) / config.frames,
+            scope.total.bytes / 1024.0 / config.frames, scope.peakBytes / 1024.0);
+    }
+
+    // 稳态帧的零分配检查
+    int exitCode = 0;
+    std::string steadyError;
+    if (!AllocationTracker::CheckZeroSteadyState(&steadyError)) {
+        std::printf("steady state: %s\n", steadyError.c_str());
+        if (config.zeroAlloc) exitCode = 3;
+    }
+
+    // 程序化点击的堆分配检查：名称预先构造好，计数区间内只有点击、入队和处理
+    // 偶数次按名称点击，奇数次按预先解析的句柄点击
+    if (!buttonGroups.empty() && config.buttons > 0 && config.clicks > 0) {
+        std::vector<std::string> groupNames, buttonNames;
+        for (int g = 0; g < config.groups; g++) groupNames.push_back("BenchGroup" + std::to_string(g));
+        for (int b = 0; b < config.buttons; b++) buttonNames.push_back("B" + std::to_string(b));
+        std::vector<GroupHandle> groupHandles;
+        for (const std::string& name : groupNames) groupHandles.push_back(MyButtonManager::findGroup(name));
+        MyButtonManager::processDeferredUpdates();
+
+        const size_t drainInterval = MyButtonManager::getDeferredQueueStats().capacity / 2;
+        const size_t runsBefore = g_deferredRuns.load(std::memory_order_relaxed);
+        const size_t allocBefore = AllocationTracker::GetTotals().allocations;
+        const Clock::time_point t0 = Clock::now();
+        for (int i = 0; i < config.clicks; i++) {
+            const int g = i % config.groups;
+            const int b = (i / config.groups) % config.buttons;
+            if (i & 1) MyButtonManager::clickButton(groupHandles[g], static_cast<ButtonHandle>(b));
+            else MyButtonManager::clickButton(groupNames[g], buttonNames[b]);
+            if (static_cast<size_t>(i + 1) % drainInterval == 0) MyButtonManager::processDeferredUpdates();
+        }
+        MyButtonManager::processDeferredUpdates();
+        const Clock::time_point t1 = Clock::now();
+        const size_t clickAllocs = AllocationTracker::GetTotals().allocations - allocBefore;
+        const bool actionsRan = g_deferredRuns.load(std::memory_order_relaxed) != runsBefore;
+
+        std::printf("programmatic clicks: %d in %.3f ms, heap allocations: %zu%s\n",
+            config.clicks, elapsedMs(t0, t1), clickAllocs, actionsRan ? "" : " (deferred actions did not run)");
+        if (clickAllocs != 0 || !actionsRan) exitCode = 2;
+    }
+
+    buttonGroups.clear();
+    ImGui::DestroyContext();
+    return exitCode;
+}
@@ -0,0 +1,93 @@
+#include "FrameScheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <utility>
+
+namespace {
+std::atomic<FrameScheduler::WakeCallback> wakeCallback{ nullptr };
+std::atomic<bool> wakePending{ false }; // 上次BeginFrame之后已经调用过回调
+thread_local bool t_schedulerThread = false;
+}
+
+double SteadyFrameClock::Now() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+FrameScheduler::FrameScheduler(IFrameClock& clock, IFrameEventSource& events, FrameSchedulerConfig config)
+    : clock(clock), events(events), config(std::move(config)) {
+    lastRenderTime = this->clock.Now();
+}
+
+void FrameScheduler::RequestFrame(int count) {
+    requestedFrames = std::max(requestedFrames, count);
+}
+
+void FrameScheduler::SetWakeCallback(WakeCallback callback) {
+    wakeCallback.store(callback, std::memory_order_release);
+}
+
+void FrameScheduler::Wake() {
+    if (t_schedulerThread) return;
+    const WakeCallback callback = wakeCallback.load(std::memory_order_acquire);
+    if (!callback) return;
+    // 已有唤醒在途时不再调用。用交换而不是先读：交换是完整的屏障，调用方此前的投递先于它可见，
+    // 与BeginFrame的清除（seq_cst）配对，清除之后的投递一定会再唤醒一次
+    if (wakePending.exchange(true)) return;
+    callback();
+}
+
+bool FrameScheduler::BeginFrame() {
+    t_schedulerThread = true;
+    // 先清除再检查脏状态：清除之前的投递由dirtyCheck看到，之后的投递会重新唤醒
+    wakePending.store(false);
+    bool dirty = config.dirtyCheck && config.dirtyCheck();
+    if (IsIdle() && !dirty) {
+        // 等待到下一次保活绘制或idleWaitTimeout，取较早者
+        double timeout = config.idleWaitTimeout;
+        if (config.maxIdleInterval > 0.0) {
+            const double untilKeepAlive = lastRenderTime + config.maxIdleInterval - clock.Now();
+            timeout = std::min(timeout, std::max(0.0, untilKeepAlive));
+        }
+        events.WaitEvents(timeout);
+        dirty = config.dirtyCheck && config.dirtyCheck();
+    }
+    else {
+        events.PollEvents();
+    }
+
+    const double now = clock.Now();
+    bool render = false;
+
+    if (events.TakeInput()) {
+        // 输入本帧立即处理，之后再连续绘制几帧
+        burstRemaining = config.burstFrames;
+        render = true;
+    }
+    else if (burstRemaining > 0) {
+        burstRemaining--;
+        render = true;
+    }
+
+    if (requestedFrames > 0) {
+        requestedFrames--;
+        render = true;
+    }
+    if (dirty) {
+        render = true;
+    }
+    // 允许1毫秒误差，避免等待刚好停在截止时间之前又多睡一轮
+    if (!render && config.maxIdleInterval > 0.0 && now - lastRenderTime >= config.maxIdleInterval - 0.001) {
+        render = true;
+    }
+
+    if (render) {
+        lastRenderTime = now;
+        renderedFrames++;
+    }
+    else {
+        skippedFrames++;
+    }
+    return render;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <functional>
+
+// 帧调度：决定主循环每次唤醒后是否需要重建UI并呈现
+//
+//   有输入        -> 立即绘制，并在之后连续绘制burstFrames帧（让悬停、动画等状态稳定下来）
+//   有脏状态      -> 绘制（RequestFrame()或dirtyCheck返回true，如延迟回调、布局重载）
+//   长时间无变化  -> 每maxIdleInterval秒绘制一次（0表示不绘制）
+//   其他          -> 跳过本次，不调用NewFrame/Render/SwapBuffers
+//
+// 空闲时通过事件源阻塞等待事件，最多等待idleWaitTimeout秒后醒来检查后台产生的脏状态。
+// 后台线程产生脏状态（延迟回调、实时数据发布、布局重载）时调用FrameScheduler::Wake()立即打断等待。
+// 时钟和事件源可注入，调度决策可以在没有窗口的环境下测试。
+
+// 时钟，单位为秒
+class IFrameClock {
+public:
+    virtual ~IFrameClock() = default;
+    virtual double Now() = 0;
+};
+
+// 事件源
+class IFrameEventSource {
+public:
+    virtual ~IFrameEventSource() = default;
+    virtual void PollEvents() = 0;                      // 处理已到达的事件，不阻塞
+    virtual void WaitEvents(double timeoutSeconds) = 0; // 阻塞直到有事件或超时
+    virtual bool TakeInput() = 0;                       // 上次调用以来是否收到过输入，并清除标记
+};
+
+// 基于std::chrono::steady_clock的时钟
+class SteadyFrameClock : public IFrameClock {
+public:
+    double Now() override;
+};
+
+struct FrameSchedulerConfig {
+    int burstFrames = 3;            // 输入后额外连续绘制的帧数
+    double idleWaitTimeout = 0.1;   // 空闲时单次等待事件的最长时间（秒）
+    double maxIdleInterval = 1.0;   // 无任何变化时的最长绘制间隔（秒），0表示不限制
+    std::function<bool()> dirtyCheck; // 每次唤醒后调用，返回true表示有待绘制的状态
+};
+
+class FrameScheduler {
+public:
+    FrameScheduler(IFrameClock& clock, IFrameEventSource& events, FrameSchedulerConfig config = {});
+
+    // 等待或处理事件，返回true表示本次需要绘制一帧
+    bool BeginFrame();
+
+    // 请求在下一次BeginFrame时绘制（count帧）
+    void RequestFrame(int count = 1);
+
+    // 跨线程唤醒：回调由程序注入（如glfwPostEmptyEvent），须能从任意线程调用。
+    // Wake()任意线程可调用，没有注入回调时什么也不做；清除回调之前须先停止仍会调用Wake()的线程。
+    // 两次BeginFrame之间只调用一次回调（生产者每秒投递上千次也只唤醒一次）；
+    // 在调用BeginFrame的线程上调用时直接返回，本轮的dirtyCheck会看到它产生的状态
+    using WakeCallback = void (*)();
+    static void SetWakeCallback(WakeCallback callback);
+    static void Wake();
+
+    // 统计
+    unsigned long long GetRenderedFrames() const { return renderedFrames; }
+    unsigned long long GetSkippedFrames() const { return skippedFrames; }
+    bool IsIdle() const { return requestedFrames == 0 && burstRemaining == 0; }
+
+private:
+    IFrameClock& clock;
+    IFrameEventSource& events;
+    FrameSchedulerConfig config;
+
+    int requestedFrames = 1;        // 启动时至少绘制一帧
+    int burstRemaining = 0;
+    double lastRenderTime = 0.0;
+    unsigned long long renderedFrames = 0;
+    unsigned long long skippedFrames = 0;
+};
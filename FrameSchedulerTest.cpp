@@ -0,0 +1,163 @@
+// FrameSchedulerTest.cpp
+// 帧调度决策测试：用注入的时钟和事件源在没有窗口的环境下检查
+// 首帧、空闲跳过、输入后的连续帧数、RequestFrame、dirtyCheck、保活间隔和跨线程唤醒的合并。
+// 由ctest运行（见CMakeLists.txt）。
+
+#include "FrameScheduler.h"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+static int failures = 0;
+
+static void Check(bool condition, const char* what) {
+    std::printf("%s: %s\n", condition ? "ok  " : "FAIL", what);
+    if (!condition) failures++;
+}
+
+class FakeClock : public IFrameClock {
+public:
+    double Now() override { return now; }
+    double now = 100.0;
+};
+
+// 等待直接把时钟推进timeout秒；输入由测试设置
+class FakeEvents : public IFrameEventSource {
+public:
+    explicit FakeEvents(FakeClock& clock) : clock(clock) {}
+    void PollEvents() override { polls++; }
+    void WaitEvents(double timeoutSeconds) override {
+        waits++;
+        lastTimeout = timeoutSeconds;
+        clock.now += timeoutSeconds;
+    }
+    bool TakeInput() override {
+        const bool received = input;
+        input = false;
+        return received;
+    }
+
+    FakeClock& clock;
+    bool input = false;
+    int polls = 0;
+    int waits = 0;
+    double lastTimeout = -1.0;
+};
+
+static FrameSchedulerConfig MakeConfig(double maxIdleInterval) {
+    FrameSchedulerConfig config;
+    config.burstFrames = 3;
+    config.idleWaitTimeout = 0.1;
+    config.maxIdleInterval = maxIdleInterval;
+    return config;
+}
+
+// 连续调用count次BeginFrame，返回绘制的次数
+static int CountRendered(FrameScheduler& scheduler, int count) {
+    int rendered = 0;
+    for (int i = 0; i < count; i++) rendered += scheduler.BeginFrame() ? 1 : 0;
+    return rendered;
+}
+
+static void TestFirstFrameAndIdle() {
+    FakeClock clock;
+    FakeEvents events(clock);
+    FrameScheduler scheduler(clock, events, MakeConfig(0.0));
+    Check(scheduler.BeginFrame(), "first frame is rendered");
+    Check(events.polls == 1 && events.waits == 0, "first frame polls instead of waiting");
+    Check(scheduler.IsIdle(), "idle after the first frame");
+
+    Check(CountRendered(scheduler, 50) == 0, "idle frames are skipped without keep-alive");
+    Check(events.waits == 50 && events.lastTimeout == 0.1, "idle frames wait idleWaitTimeout");
+    Check(scheduler.GetRenderedFrames() == 1 && scheduler.GetSkippedFrames() == 50, "rendered and skipped counters");
+}
+
+static void TestInputBurst() {
+    FakeClock clock;
+    FakeEvents events(clock);
+    FrameScheduler scheduler(clock, events, MakeConfig(0.0));
+    scheduler.BeginFrame();
+
+    events.input = true;
+    Check(scheduler.BeginFrame(), "input renders immediately");
+    Check(CountRendered(scheduler, 3) == 3, "burstFrames frames follow the input");
+    Check(!scheduler.BeginFrame(), "burst ends after burstFrames");
+
+    // 输入在空闲等待中到达，之后的连续帧不再等待
+    events.input = true;
+    scheduler.BeginFrame();
+    const int waits = events.waits;
+    CountRendered(scheduler, 3);
+    Check(events.waits == waits, "no waiting during a burst");
+}
+
+static void TestRequestFrameAndDirty() {
+    FakeClock clock;
+    FakeEvents events(clock);
+    bool dirty = false;
+    FrameSchedulerConfig config = MakeConfig(0.0);
+    config.dirtyCheck = [&dirty] { return dirty; };
+    FrameScheduler scheduler(clock, events, config);
+    scheduler.BeginFrame();
+
+    scheduler.RequestFrame(2);
+    Check(CountRendered(scheduler, 2) == 2, "RequestFrame(2) renders two frames");
+    Check(!scheduler.BeginFrame(), "requested frames are consumed");
+
+    dirty = true;
+    Check(CountRendered(scheduler, 3) == 3, "dirtyCheck renders while dirty");
+    dirty = false;
+    Check(!scheduler.BeginFrame(), "clean dirtyCheck skips");
+}
+
+static void TestKeepAlive() {
+    FakeClock clock;
+    FakeEvents events(clock);
+    FrameScheduler scheduler(clock, events, MakeConfig(1.0));
+    scheduler.BeginFrame();
+
+    const double start = clock.now;
+    int iterations = 0;
+    while (!scheduler.BeginFrame() && iterations < 100) iterations++;
+    const double elapsed = clock.now - start;
+    Check(elapsed >= 0.999 && elapsed <= 1.0 + 1e-9, "keep-alive frame after maxIdleInterval");
+    Check(iterations >= 9 && iterations <= 11, "keep-alive wait is split into idleWaitTimeout steps");
+}
+
+static std::atomic<int> wakeCount{ 0 };
+
+static void TestWakeCoalescing() {
+    FakeClock clock;
+    FakeEvents events(clock);
+    FrameScheduler scheduler(clock, events, MakeConfig(0.0));
+    FrameScheduler::SetWakeCallback([] { wakeCount++; });
+    scheduler.BeginFrame();
+
+    auto wakeFromWorker = [](int count) {
+        std::thread worker([count] {
+            for (int i = 0; i < count; i++) FrameScheduler::Wake();
+        });
+        worker.join();
+    };
+    wakeFromWorker(1000);
+    Check(wakeCount == 1, "wakes between frames are coalesced");
+
+    scheduler.BeginFrame();
+    wakeFromWorker(10);
+    Check(wakeCount == 2, "BeginFrame re-arms the wake");
+
+    scheduler.BeginFrame();
+    FrameScheduler::Wake();
+    Check(wakeCount == 2, "wake on the scheduler thread is skipped");
+
+    FrameScheduler::SetWakeCallback(nullptr);
+}
+
+int main() {
+    TestFirstFrameAndIdle();
+    TestInputBurst();
+    TestRequestFrameAndDirty();
+    TestKeepAlive();
+    TestWakeCoalescing();
+    return failures == 0 ? 0 : 1;
+}
@@ -1,220 +1,310 @@
-﻿#include "RegionManager.h"
-#include "imgui_impl_glfw.h"
-#include "imgui_impl_opengl3.h"
-#include <GLFW/glfw3.h>
-
-///////////////////////////////////////////////////////////////////////////// MyButtonGroup
-#include "MyButtonGroup.h"
-#include "MessageManager.h"
-#include <imgui.h>
-#include <random>
-
-// 测试用例
-void drawMyButtonGroups() {
-
-    // 创建回调函数
-    static auto callbackA = [] { ImGui::Text("Callback: Group2-A"); };
-    static auto callbackB = [] { ImGui::Text("Callback: Group2-B"); };
-    static auto callbackC = [] { ImGui::Text("Callback: Group2-C"); };
-
-    static auto callbackX = [] { ImGui::Text("Callback: Group3-X"); };
-    static auto callbackY = [] { ImGui::Text("Callback: Group3-Y"); };
-
-    // 创建按钮组 (使用新的构造函数)
-    static MyButtonGroup group1("Group1", {
-            {
-                "Button1", 0.3f, [] { 
-                MyButtonManager::deferUIUpdate([]{ 
-                    MessageManager::addMessage("Callback: Group1-Button1");
-                });
-            }},
-            {
-                "Button2", 0.5f, [] {
-                MyButtonManager::deferUIUpdate([] {
-                    MessageManager::addMessage("Callback: Group1-Button2 - Changing other groups");
-                });
-            }},
-            {
-                "Button3", 0.2f, [] {
-                MyButtonManager::deferUIUpdate([] {
-                    MessageManager::addMessage("Callback: Group1-Button3 - Changing other groups");
-                });
-                MyButtonManager::setHighlight("Group2", "B");
-                MyButtonManager::clickButton("Group3", "X");
-            }}
-        });
-
-    static MyButtonGroup group2("Group2", {
-        {"A", 0.4f, []{}},
-        {"B", 0.3f, []{}},
-        {"C", 0.3f, []{}}
-        });
-
-    static MyButtonGroup group3("Group3", {
-        {"X", 0.6f, []{}},
-        {"Y", 0.4f, []{}}
-        });
-
-    static bool s_bInit{ true };
-    if (s_bInit) {
-        s_bInit = false;
-
-        // 注册到管理器
-        MyButtonManager::addGroup(&group1);
-        MyButtonManager::addGroup(&group2);
-        MyButtonManager::addGroup(&group3);
-
-        // 设置初始高亮
-        MyButtonManager::setHighlight("Group1", "Button1");
-        MyButtonManager::setHighlight("Group2", "A");
-        MyButtonManager::setHighlight("Group3", "Y");
-    }
-
-
-    // 渲染函数 (需要在每帧调用)
-    static auto renderGroups = [&] {
-        group1.render();
-        group2.render();
-        group3.render();
-
-        // 显示调试信息
-        ImGui::Separator();
-        ImGui::Text("Interaction Example:");
-        if (ImGui::Button("Programmatically click Group1-Button2")) {
-            MyButtonManager::clickButton("Group1", "Button2");
-        }
-        ImGui::SameLine();
-        if (ImGui::Button("Highlight Group2-C")) {
-            MyButtonManager::setHighlight("Group2", "C");
-        }
-    };
-
-    renderGroups();
-
-    // 在ImGui渲染之后，交换缓冲区之前
-    MyButtonManager::processDeferredUpdates();
-
-    // 渲染所有消息
-    ImGui::Separator();
-    ImGui::Text("Messages:");
-    MessageManager::renderMessages();
-}
-
-
-//////////////////////////////////////////////////////////// RegionManager
-// 全局实例
-RegionManager regionManager;
-
-
-void drawRegionUI() {
-    if (ImGui::Button("Reload Config")) {
-        regionManager.ReloadConfig();
-    }
-    ImGui::SameLine();
-    ImGui::Text("Press F5 to reload layout from file");
-    regionManager.DrawUI();
-}
-
-// 主UI函数
-void DrawMainUI() {
-    ImGui::SetNextWindowPos(ImVec2(0, 0));
-    ImVec2 displaySize = ImGui::GetIO().DisplaySize;
-    ImGui::SetNextWindowSize(displaySize);
-
-    ImGui::Begin("Hierarchical Region Layout", nullptr,
-        ImGuiWindowFlags_NoTitleBar |
-        ImGuiWindowFlags_NoResize |
-        ImGuiWindowFlags_NoMove |
-        ImGuiWindowFlags_NoCollapse |
-        ImGuiWindowFlags_NoScrollbar);
-
-    //drawRegionUI();
-
-    drawMyButtonGroups();
-    
-
-    ImGui::End();
-}
-
-// 初始化GLFW窗口
-GLFWwindow* CreateGLFWWindow() {
-    if (!glfwInit()) return nullptr;
-
-    GLFWwindow* window = glfwCreateWindow(1280, 720, "Hierarchical Region Layout", NULL, NULL);
-    if (!window) {
-        glfwTerminate();
-        return nullptr;
-    }
-
-    glfwMakeContextCurrent(window);
-    glfwSwapInterval(1); // 启用垂直同步
-
-    // 初始化ImGui
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGuiIO& io = ImGui::GetIO(); (void)io;
-
-    // 设置DPI缩放
-    float xscale, yscale;
-    glfwGetWindowContentScale(window, &xscale, &yscale);
-    io.FontGlobalScale = xscale;
-    ImGui::GetStyle().ScaleAllSizes(xscale);
-
-    // 初始化平台后端
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL3_Init("#version 130");
-
-    // 设置样式
-    ImGui::StyleColorsLight();
-
-    return window;
-}
-
-// 主循环
-void MainLoop(GLFWwindow* window) {
-    while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
-
-        // 获取framebuffer尺寸（处理高DPI）
-        int display_w, display_h;
-        glfwGetFramebufferSize(window, &display_w, &display_h);
-
-        // 设置视口
-        glViewport(0, 0, display_w, display_h);
-        glClearColor(0.45f, 0.55f, 0.60f, 1.00f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        // ImGui新帧
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-
-        DrawMainUI();
-
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-        glfwSwapBuffers(window);
-    }
-}
-
-// 清理资源
-void Cleanup(GLFWwindow* window) {
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
-
-    glfwDestroyWindow(window);
-    glfwTerminate();
-}
-
-// 主函数
-int main() {
-    GLFWwindow* window = CreateGLFWWindow();
-    if (!window) return 1;
-
-    MainLoop(window);
-    Cleanup(window);
-
-    return 0;
+﻿#include "RegionManager.h"
+#include "DashboardInstance.h"
+#include "imgui_impl_glfw.h"
+#include "imgui_impl_opengl3.h"
+#include <GLFW/glfw3.h>
+
+///////////////////////////////////////////////////////////////////////////// MyButtonGroup
+#include "MyButtonGroup.h"
+#include "MessageManager.h"
+#include "Profiler.h"
+#include "AllocationTracker.h"
+#include "FrameScheduler.h"
+#include "InputRecording.h"
+#include "LogSink.h"
+#include "LayoutLoader.h"
+#include <imgui.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////////////// 仪表盘
+// 演示窗口的全部内容（按钮组、消息、区域管理器）由一个仪表盘实例持有，在CreateGLFWWindow中创建
+std::unique_ptr<DashboardInstance> dashboard;
+
+// 主UI函数
+void DrawMainUI() {
+    PROFILE_SCOPE("DrawMainUI");
+    ALLOC_SCOPE("DrawMainUI");
+
+    dashboard->DrawUI();
+
+#ifdef MYIMGUI_ENABLE_PROFILER
+    // 性能分析和堆分配叠加窗口
+    Profiler::DrawOverlay();
+    AllocationTracker::DrawOverlay();
+#endif
+}
+
+//////////////////////////////////////////////////////////// 帧调度
+// GLFW事件源：记录两次调度之间是否收到过输入或窗口事件
+class GlfwEventSource : public IFrameEventSource {
+public:
+    // 必须在ImGui_ImplGlfw_InitForOpenGL之前调用，ImGui后端会把这些回调串接为前一个回调
+    void Install(GLFWwindow* window) {
+        glfwSetCursorPosCallback(window, [](GLFWwindow*, double, double) { inputReceived = true; });
+        glfwSetMouseButtonCallback(window, [](GLFWwindow*, int, int, int) { inputReceived = true; });
+        glfwSetScrollCallback(window, [](GLFWwindow*, double, double) { inputReceived = true; });
+        glfwSetKeyCallback(window, [](GLFWwindow*, int, int, int, int) { inputReceived = true; });
+        glfwSetCharCallback(window, [](GLFWwindow*, unsigned int) { inputReceived = true; });
+        glfwSetCursorEnterCallback(window, [](GLFWwindow*, int) { inputReceived = true; });
+        glfwSetWindowFocusCallback(window, [](GLFWwindow*, int) { inputReceived = true; });
+        glfwSetWindowSizeCallback(window, [](GLFWwindow*, int, int) { inputReceived = true; });
+        glfwSetWindowRefreshCallback(window, [](GLFWwindow*) { inputReceived = true; });
+    }
+
+    void PollEvents() override { glfwPollEvents(); }
+    void WaitEvents(double timeoutSeconds) override { glfwWaitEventsTimeout(timeoutSeconds); }
+    bool TakeInput() override {
+        const bool received = inputReceived;
+        inputReceived = false;
+        return received;
+    }
+
+private:
+    static inline bool inputReceived = false; // 回调只在主线程的Poll/Wait中触发
+};
+
+GlfwEventSource glfwEventSource;
+
+// 输入录制（--record），未打开时不做任何事
+InputRecorder inputRecorder;
+
+// 初始化GLFW窗口，imguiArena为true时ImGui的内部缓冲区使用块池
+GLFWwindow* CreateGLFWWindow(bool imguiArena) {
+    if (!glfwInit()) return nullptr;
+
+    GLFWwindow* window = glfwCreateWindow(1280, 720, "Hierarchical Region Layout", NULL, NULL);
+    if (!window) {
+        glfwTerminate();
+        return nullptr;
+    }
+
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(1); // 启用垂直同步
+
+    // 初始化ImGui（先安装分配函数，ImGui的分配计入堆统计）
+    IMGUI_CHECKVERSION();
+    AllocationTracker::InstallImGuiAllocator(imguiArena);
+
+    // 创建仪表盘实例（ImGui上下文、样式和DPI缩放），字体纹理在第一帧由渲染后端创建
+    float xscale, yscale;
+    glfwGetWindowContentScale(window, &xscale, &yscale);
+    DashboardConfig config;
+    config.iniFilename = "imgui.ini";
+    config.contentScale = xscale;
+    config.regionThreads = 0; // 大布局的布局计算和几何细分分散到所有核心
+    dashboard = std::make_unique<DashboardInstance>(config);
+    MyButtonManager::setUIContext(dashboard->GetButtonContext()); // 后台线程的延迟回调由主循环处理
+
+    // 初始化平台后端（先安装输入检测回调，由ImGui后端串接调用）
+    glfwEventSource.Install(window);
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 130");
+
+    return window;
+}
+
+// 主循环
+void MainLoop(GLFWwindow* window) {
+    // 没有输入、延迟回调和待应用的布局时不重建UI，也不呈现
+    SteadyFrameClock clock;
+    FrameSchedulerConfig schedulerConfig;
+    schedulerConfig.dirtyCheck = [] {
+        const RegionManager& regions = dashboard->GetRegionManager();
+        return MyButtonManager::getDeferredQueueStats().pending > 0 || regions.HasPendingLayout() || regions.HasPendingLiveData();
+    };
+    FrameScheduler scheduler(clock, glfwEventSource, std::move(schedulerConfig));
+    FrameScheduler::SetWakeCallback(glfwPostEmptyEvent); // 后台线程投递后打断glfwWaitEventsTimeout
+
+    while (!glfwWindowShouldClose(window)) {
+        bool shouldRender;
+        {
+            PROFILE_SCOPE("WaitEvents");
+            shouldRender = scheduler.BeginFrame();
+        }
+        if (!shouldRender) {
+            continue;
+        }
+        AllocationTracker::BeginFrame();
+
+        // 获取framebuffer尺寸（处理高DPI）
+        int display_w, display_h;
+        glfwGetFramebufferSize(window, &display_w, &display_h);
+
+        // 设置视口
+        glViewport(0, 0, display_w, display_h);
+        glClearColor(0.45f, 0.55f, 0.60f, 1.00f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // ImGui新帧
+        {
+            PROFILE_SCOPE("NewFrame");
+            ALLOC_SCOPE("NewFrame");
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+        }
+        inputRecorder.BeginFrame(ImGui::GetIO());
+
+        DrawMainUI();
+
+        {
+            PROFILE_SCOPE("Render");
+            ALLOC_SCOPE("Render");
+            ImGui::Render();
+            inputRecorder.EndFrame(ImGui::GetDrawData());
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
+
+        {
+            PROFILE_SCOPE("SwapBuffers");
+            glfwSwapBuffers(window);
+        }
+        AllocationTracker::EndFrame();
+        PROFILE_FRAME_END();
+    }
+}
+
+// 清理资源
+void Cleanup(GLFWwindow* window) {
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    dashboard.reset();
+    FrameScheduler::SetWakeCallback(nullptr); // 布局监视线程已随dashboard停止，glfwTerminate之后不能再投递空事件
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
+
+//////////////////////////////////////////////////////////// 回放
+// 无窗口回放录制的输入：每帧把录制的输入送入无后端的ImGui上下文并运行DrawMainUI，
+// 输出每帧耗时、堆分配次数和绘制数据校验和（CSV），并与录制时的校验和比较。
+// 校验和不一致时返回2（开启性能分析叠加窗口时其中的耗时文字每次都不同，需关闭后比较）
+int RunReplay(const std::string& path, bool imguiArena) {
+    InputReplayer replayer;
+    std::string error;
+    if (!replayer.Open(path, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    // 与CreateGLFWWindow相同的仪表盘设置（图集与录制时相同，纹理坐标才一致），只是没有平台/渲染后端
+    IMGUI_CHECKVERSION();
+    AllocationTracker::InstallImGuiAllocator(imguiArena);
+    DashboardConfig config;
+    config.contentScale = replayer.GetContentScale();
+    config.regionThreads = 0;
+    dashboard = std::make_unique<DashboardInstance>(config);
+    ImGuiIO& io = ImGui::GetIO();
+    io.ConfigInputTrickleEventQueue = false;                 // 每帧的输入在同一帧全部生效，与录制的状态一致
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset; // 与OpenGL3后端相同，绘制命令的划分才一致
+    io.Fonts->SetTexID(reinterpret_cast<ImTextureID>(static_cast<intptr_t>(1)));
+
+    // 布局同步加载，回放从第一帧起就是确定的
+    RegionTree tree;
+    if (LoadLayoutFile("RegionLayout.txt", tree, &error)) {
+        dashboard->GetRegionManager().SetTree(std::move(tree));
+    }
+    else {
+        std::fprintf(stderr, "%s\n", error.c_str());
+    }
+
+    const bool compareChecksums = replayer.GetImGuiVersion() == IMGUI_VERSION_NUM;
+    if (!compareChecksums) {
+        std::fprintf(stderr, "recorded with ImGui %u, running %d: checksums are not compared\n",
+            replayer.GetImGuiVersion(), IMGUI_VERSION_NUM);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point a, Clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+
+    std::vector<double> frameMs;
+    int mismatches = 0;
+    unsigned long long sessionChecksum = 0xcbf29ce484222325ull;
+    std::printf("frame,newframe_ms,ui_ms,render_ms,vertices,allocs,checksum,match\n");
+    while (replayer.NextFrame(io, &error)) {
+        AllocationTracker::BeginFrame();
+        const Clock::time_point t0 = Clock::now();
+        ImGui::NewFrame();
+        const Clock::time_point t1 = Clock::now();
+        DrawMainUI();
+        const Clock::time_point t2 = Clock::now();
+        ImGui::Render();
+        const Clock::time_point t3 = Clock::now();
+        AllocationTracker::EndFrame();
+
+        const unsigned long long checksum = ChecksumDrawData(ImGui::GetDrawData());
+        const bool match = !compareChecksums || checksum == replayer.GetRecordedChecksum();
+        if (!match) mismatches++;
+        sessionChecksum = (sessionChecksum ^ checksum) * 0x100000001b3ull;
+        frameMs.push_back(elapsedMs(t0, t3));
+        std::printf("%d,%.3f,%.3f,%.3f,%d,%zu,%016llx,%d\n", replayer.GetFrameIndex(),
+            elapsedMs(t0, t1), elapsedMs(t1, t2), elapsedMs(t2, t3),
+            ImGui::GetDrawData()->TotalVtxCount, AllocationTracker::GetLastFrame().counters.allocations,
+            checksum, match ? 1 : 0);
+    }
+
+    dashboard.reset();
+    if (!error.empty()) {
+        std::fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str());
+        return 1;
+    }
+
+    std::sort(frameMs.begin(), frameMs.end());
+    auto percentile = [&](double p) {
+        return frameMs.empty() ? 0.0 : frameMs[std::min(frameMs.size() - 1, static_cast<size_t>(p * (frameMs.size() - 1) + 0.5))];
+    };
+    std::printf("# frames: %zu  p50: %.3f ms  p99: %.3f ms  max: %.3f ms  checksum: %016llx  mismatches: %d\n",
+        frameMs.size(), percentile(0.50), percentile(0.99), frameMs.empty() ? 0.0 : frameMs.back(),
+        sessionChecksum, mismatches);
+    return mismatches > 0 ? 2 : 0;
+}
+
+// 主函数
+// ImGuiDemo [--record FILE]   正常运行，并把每帧输入录制到FILE
+// ImGuiDemo --replay FILE     无窗口回放FILE，输出每帧耗时和校验和
+// --arena 1                   ImGui的内部缓冲区使用块池分配（两种模式都可用）
+int main(int argc, char** argv) {
+    std::string recordPath, replayPath;
+    bool imguiArena = false;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "--replay")) replayPath = argv[i + 1];
+        if (!std::strcmp(argv[i], "--record")) recordPath = argv[i + 1];
+        if (!std::strcmp(argv[i], "--arena")) imguiArena = std::atoi(argv[i + 1]) != 0;
+    }
+    if (!replayPath.empty()) return RunReplay(replayPath, imguiArena);
+
+    GLFWwindow* window = CreateGLFWWindow(imguiArena);
+    if (!window) return 1;
+
+    // 点击和消息异步写入日志文件（轮转保留最近5个），退出前写完
+    std::string logError;
+    if (!LogSink::Open(LogSinkConfig(), &logError)) {
+        std::fprintf(stderr, "%s\n", logError.c_str());
+    }
+
+    if (!recordPath.empty()) {
+        std::string error;
+        if (!inputRecorder.Open(recordPath, ImGui::GetIO().FontGlobalScale, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+        }
+    }
+
+    // 从文件加载区域布局，文件修改后自动重新加载
+    dashboard->GetRegionManager().WatchLayoutFile("RegionLayout.txt");
+
+    MainLoop(window);
+    inputRecorder.Close();
+    Cleanup(window);
+    LogSink::Close();
+
+    return 0;
 }
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+// ImGui当前上下文的线程模型（见ImGuiUserConfig.h）
+// 以线程局部的GImGui编译时，没有当前上下文的工作线程调用ImDrawList等（经ImGui::MemAlloc分配内存）
+// 不会触及任何上下文，可以并行细分几何、并行构建不同上下文的帧；否则这些调用会修改共享的全局上下文。
+
+#include <imgui.h>
+
+// 构建要求线程局部的上下文，但这个源文件没有以ImGuiUserConfig.h编译（部分源文件缺少配置时GImGui违反ODR）
+#if defined(REGION_CONCURRENT_IMGUI) && !defined(GImGui)
+#error "REGION_CONCURRENT_IMGUI requires IMGUI_USER_CONFIG=\"ImGuiUserConfig.h\" on every source file"
+#endif
+
+#ifdef GImGui
+constexpr bool IMGUI_THREAD_LOCAL_CONTEXT = true;
+#else
+constexpr bool IMGUI_THREAD_LOCAL_CONTEXT = false;
+#endif
+
+// ImGui自身（imgui.cpp）是否与本项目使用同一个线程局部的GImGui：
+// SetCurrentContext之后ImGui的当前上下文与这里看到的GImGui一致，在调用线程有当前上下文时检查
+inline bool IsImGuiContextThreadLocal() {
+#ifdef GImGui
+    return ImGui::GetCurrentContext() != nullptr && ImGui::GetCurrentContext() == GImGui;
+#else
+    return false;
+#endif
+}
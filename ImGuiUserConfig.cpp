@@ -0,0 +1,6 @@
+#include "ImGuiThreading.h"
+
+// 以ImGuiUserConfig.h编译时GImGui是宏，ImGui自身不再定义GImGui，由这里提供线程局部的定义
+#ifdef GImGui
+thread_local ImGuiContext* ImGuiThreadContext = nullptr;
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+// ImGui编译配置：ImGui和本项目的所有源文件都以
+//   IMGUI_USER_CONFIG="ImGuiUserConfig.h" 和 REGION_CONCURRENT_IMGUI
+// 编译时生效（CMakeLists.txt在imgui库上以PUBLIC方式设置，链接它的目标都会继承）。
+// 当前上下文GImGui改为线程局部变量，多个ImGui上下文可以在不同线程上同时构建帧
+// （每个线程先SetCurrentContext；同一个上下文同一时刻只能在一个线程上使用）。
+// 未使用该配置时DashboardInstance退化为串行构建，区域几何也只在调用线程上细分（见ImGuiThreading.h）。
+
+#ifndef REGION_CONCURRENT_IMGUI
+#error "ImGuiUserConfig.h must be used together with REGION_CONCURRENT_IMGUI on every source file"
+#endif
+
+struct ImGuiContext;
+extern thread_local ImGuiContext* ImGuiThreadContext; // 定义在ImGuiUserConfig.cpp
+#define GImGui ImGuiThreadContext
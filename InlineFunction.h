@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <imgui.h>
+
+// 小缓冲区可调用对象：可调用对象直接存放在内部固定大小的缓冲区里，从不分配堆内存。
+// 捕获的数据超过Capacity时编译失败（而不是退化为堆分配）。
+// 默认只能移动；Copyable为true时要求可调用对象可拷贝，并允许拷贝。
+template<typename Signature, size_t Capacity, bool Copyable = false>
+class InlineFunction;
+
+template<typename R, typename... Args, size_t Capacity, bool Copyable>
+class InlineFunction<R(Args...), Capacity, Copyable> {
+public:
+    InlineFunction() noexcept = default;
+    InlineFunction(std::nullptr_t) noexcept {}
+
+    template<typename F, typename Fn = std::decay_t<F>,
+        typename = std::enable_if_t<!std::is_same_v<Fn, InlineFunction> && std::is_invocable_r_v<R, Fn&, Args...>>>
+    InlineFunction(F&& func) {
+        static_assert(sizeof(Fn) <= Capacity, "callable is too large for InlineFunction, reduce its captures");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t), "callable is over-aligned for InlineFunction");
+        static_assert(!Copyable || std::is_copy_constructible_v<Fn>, "copyable InlineFunction requires a copyable callable");
+        new (storage) Fn(std::forward<F>(func));
+        ops = &OpsFor<Fn>::table;
+    }
+
+    InlineFunction(InlineFunction&& other) noexcept {
+        MoveFrom(other);
+    }
+
+    InlineFunction& operator=(InlineFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    InlineFunction(const InlineFunction& other) {
+        static_assert(Copyable, "InlineFunction is move-only");
+        CopyFrom(other);
+    }
+
+    InlineFunction& operator=(const InlineFunction& other) {
+        static_assert(Copyable, "InlineFunction is move-only");
+        if (this != &other) {
+            reset();
+            CopyFrom(other);
+        }
+        return *this;
+    }
+
+    ~InlineFunction() {
+        reset();
+    }
+
+    R operator()(Args... args) const {
+        IM_ASSERT(ops && "calling an empty InlineFunction");
+        return ops->invoke(const_cast<unsigned char*>(storage), std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept { return ops != nullptr; }
+
+    void reset() noexcept {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        R (*invoke)(void* object, Args&&... args);
+        void (*move)(void* dst, void* src) noexcept; // 移动构造到dst并析构src
+        void (*copy)(void* dst, const void* src);
+        void (*destroy)(void* object) noexcept;
+    };
+
+    template<typename Fn>
+    struct OpsFor {
+        static R Invoke(void* object, Args&&... args) {
+            return (*static_cast<Fn*>(object))(std::forward<Args>(args)...);
+        }
+        static void Move(void* dst, void* src) noexcept {
+            new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        }
+        static void Copy(void* dst, const void* src) {
+            if constexpr (Copyable) {
+                new (dst) Fn(*static_cast<const Fn*>(src));
+            }
+        }
+        static void Destroy(void* object) noexcept {
+            static_cast<Fn*>(object)->~Fn();
+        }
+        static constexpr Ops table = { &Invoke, &Move, &Copy, &Destroy };
+    };
+
+    void MoveFrom(InlineFunction& other) noexcept {
+        if (other.ops) {
+            other.ops->move(storage, other.storage);
+            ops = other.ops;
+            other.ops = nullptr;
+        }
+    }
+
+    void CopyFrom(const InlineFunction& other) {
+        if (other.ops) {
+            other.ops->copy(storage, other.storage);
+            ops = other.ops;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[Capacity];
+    const Ops* ops = nullptr;
+};
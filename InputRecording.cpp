@@ -0,0 +1,314 @@
+#include "InputRecording.h"
+#include <cstring>
+
+namespace {
+
+constexpr char RECORDING_MAGIC[8] = { 'I', 'M', 'I', 'N', 'P', 'U', 'T', '\0' };
+
+struct RecordingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t imguiVersion;  // 录制时的IMGUI_VERSION_NUM，版本不同时校验和不可比
+    float contentScale;     // 窗口内容缩放（字体和样式按此缩放）
+    uint32_t reserved;
+};
+
+// 帧记录的变化掩码，对应的数据按位序依次出现
+enum FrameFields : uint16_t {
+    FIELD_DISPLAY = 1 << 0,       // float 显示宽高、帧缓冲缩放x/y
+    FIELD_MODS = 1 << 1,          // uint8 修饰键
+    FIELD_KEYS = 1 << 2,          // uint16 数量，uint16 * 数量（按键下标，最高位为按下）
+    FIELD_MOUSE_POS = 1 << 3,     // float x, y
+    FIELD_MOUSE_BUTTONS = 1 << 4, // uint8 按钮位
+    FIELD_MOUSE_WHEEL = 1 << 5,   // float 水平、垂直
+    FIELD_TEXT = 1 << 6,          // uint16 数量，uint32 * 数量（Unicode码点）
+};
+
+constexpr uint16_t KEY_DOWN_BIT = 0x8000;
+constexpr ImGuiKey MOD_KEYS[] = { ImGuiMod_Ctrl, ImGuiMod_Shift, ImGuiMod_Alt, ImGuiMod_Super };
+
+// 修饰键的内部按键，由ImGuiMod_*事件驱动，不单独录制
+bool IsReservedModKey(int key) {
+    return key >= ImGuiKey_ReservedForModCtrl && key <= ImGuiKey_ReservedForModSuper;
+}
+
+template<typename T>
+void Append(std::vector<unsigned char>& out, const T& value) {
+    const size_t offset = out.size();
+    out.resize(offset + sizeof(T));
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+template<typename T>
+void Patch(std::vector<unsigned char>& out, size_t offset, const T& value) {
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+template<typename T>
+bool Read(const char*& cursor, const char* end, T& value) {
+    if (static_cast<size_t>(end - cursor) < sizeof(T)) return false;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return true;
+}
+
+bool SameVec(const ImVec2& a, const ImVec2& b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+template<typename T>
+uint64_t HashValue(uint64_t hash, const T& value) {
+    return HashBytes(hash, &value, sizeof(T));
+}
+
+} // namespace
+
+uint64_t ChecksumDrawData(const ImDrawData* drawData) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    if (!drawData || !drawData->Valid) return hash;
+    hash = HashValue(hash, drawData->DisplayPos);
+    hash = HashValue(hash, drawData->DisplaySize);
+    hash = HashValue(hash, drawData->CmdListsCount);
+    for (int n = 0; n < drawData->CmdListsCount; n++) {
+        const ImDrawList* list = drawData->CmdLists[n];
+        hash = HashValue(hash, list->VtxBuffer.Size);
+        hash = HashBytes(hash, list->VtxBuffer.Data, list->VtxBuffer.size_in_bytes());
+        hash = HashValue(hash, list->IdxBuffer.Size);
+        hash = HashBytes(hash, list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes());
+        for (const ImDrawCmd& cmd : list->CmdBuffer) {
+            hash = HashValue(hash, cmd.ClipRect);
+            hash = HashValue(hash, cmd.ElemCount);
+            hash = HashValue(hash, cmd.IdxOffset);
+            hash = HashValue(hash, cmd.VtxOffset);
+            hash = HashValue(hash, cmd.UserCallback != nullptr);
+        }
+    }
+    return hash;
+}
+
+///////////////////////////////////////////////////////////////////////////// 录制
+InputRecorder::~InputRecorder() {
+    Close();
+}
+
+bool InputRecorder::Open(const std::string& path, float contentScale, std::string* error) {
+    Close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        if (error) *error = "cannot create " + path;
+        return false;
+    }
+    RecordingHeader header = {};
+    std::memcpy(header.magic, RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    header.version = INPUT_RECORDING_VERSION;
+    header.imguiVersion = IMGUI_VERSION_NUM;
+    header.contentScale = contentScale;
+    std::fwrite(&header, sizeof(header), 1, file);
+
+    last = RecordedInputState();
+    record.reserve(256);
+    frameCount = 0;
+    return true;
+}
+
+void InputRecorder::Close() {
+    if (!file) return;
+    std::fclose(file);
+    file = nullptr;
+}
+
+void InputRecorder::BeginFrame(const ImGuiIO& io) {
+    if (!file) return;
+    record.clear();
+    Append(record, uint16_t(0)); // 变化掩码，最后回填
+    Append(record, io.DeltaTime);
+    uint16_t fields = 0;
+
+    if (!SameVec(io.DisplaySize, last.displaySize) || !SameVec(io.DisplayFramebufferScale, last.framebufferScale)) {
+        fields |= FIELD_DISPLAY;
+        Append(record, io.DisplaySize);
+        Append(record, io.DisplayFramebufferScale);
+        last.displaySize = io.DisplaySize;
+        last.framebufferScale = io.DisplayFramebufferScale;
+    }
+
+    const unsigned int mods = (io.KeyCtrl ? 1u : 0u) | (io.KeyShift ? 2u : 0u) | (io.KeyAlt ? 4u : 0u) | (io.KeySuper ? 8u : 0u);
+    if (mods != last.mods) {
+        fields |= FIELD_MODS;
+        Append(record, static_cast<uint8_t>(mods));
+        last.mods = mods;
+    }
+
+    // 只写状态变化的按键
+    const size_t keyCountOffset = record.size();
+    uint16_t keyCount = 0;
+    Append(record, keyCount);
+    for (int key = ImGuiKey_NamedKey_BEGIN; key < ImGuiKey_NamedKey_END; key++) {
+        if (IsReservedModKey(key)) continue;
+        const size_t bit = static_cast<size_t>(key - ImGuiKey_NamedKey_BEGIN);
+        const bool down = ImGui::IsKeyDown(static_cast<ImGuiKey>(key));
+        if (down == last.keys.test(bit)) continue;
+        last.keys.set(bit, down);
+        Append(record, static_cast<uint16_t>(bit | (down ? KEY_DOWN_BIT : 0)));
+        keyCount++;
+    }
+    if (keyCount > 0) {
+        fields |= FIELD_KEYS;
+        Patch(record, keyCountOffset, keyCount);
+    }
+    else {
+        record.resize(keyCountOffset);
+    }
+
+    if (!SameVec(io.MousePos, last.mousePos)) {
+        fields |= FIELD_MOUSE_POS;
+        Append(record, io.MousePos);
+        last.mousePos = io.MousePos;
+    }
+
+    unsigned int buttons = 0;
+    for (int b = 0; b < ImGuiMouseButton_COUNT; b++) {
+        if (io.MouseDown[b]) buttons |= 1u << b;
+    }
+    if (buttons != last.mouseButtons) {
+        fields |= FIELD_MOUSE_BUTTONS;
+        Append(record, static_cast<uint8_t>(buttons));
+        last.mouseButtons = buttons;
+    }
+
+    // 滚轮和字符是本帧的增量，非零时才写
+    if (io.MouseWheel != 0.0f || io.MouseWheelH != 0.0f) {
+        fields |= FIELD_MOUSE_WHEEL;
+        Append(record, io.MouseWheelH);
+        Append(record, io.MouseWheel);
+    }
+    if (!io.InputQueueCharacters.empty()) {
+        fields |= FIELD_TEXT;
+        Append(record, static_cast<uint16_t>(io.InputQueueCharacters.Size));
+        for (ImWchar c : io.InputQueueCharacters) {
+            Append(record, static_cast<uint32_t>(c));
+        }
+    }
+
+    Patch(record, 0, fields);
+}
+
+void InputRecorder::EndFrame(const ImDrawData* drawData) {
+    if (!file || record.empty()) return;
+    Append(record, ChecksumDrawData(drawData));
+    std::fwrite(record.data(), 1, record.size(), file);
+    record.clear();
+    frameCount++;
+}
+
+///////////////////////////////////////////////////////////////////////////// 回放
+bool InputReplayer::Open(const std::string& path, std::string* error) {
+    if (!file.Open(path)) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    const std::string_view data = file.View();
+    RecordingHeader header;
+    if (data.size() < sizeof(header)) {
+        if (error) *error = path + ": not an input recording";
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0) {
+        if (error) *error = path + ": not an input recording";
+        return false;
+    }
+    if (header.version != INPUT_RECORDING_VERSION) {
+        if (error) *error = path + ": unsupported recording version " + std::to_string(header.version);
+        return false;
+    }
+    contentScale = header.contentScale > 0.0f ? header.contentScale : 1.0f;
+    imguiVersion = header.imguiVersion;
+    cursor = data.data() + sizeof(header);
+    end = data.data() + data.size();
+    state = RecordedInputState();
+    frameIndex = -1;
+    return true;
+}
+
+bool InputReplayer::NextFrame(ImGuiIO& io, std::string* error) {
+    if (error) error->clear();
+    if (cursor == end) return false;
+
+    auto fail = [&](const char* what) {
+        if (error) *error = "frame " + std::to_string(frameIndex + 1) + ": " + what;
+        cursor = end;
+        return false;
+    };
+
+    uint16_t fields;
+    float deltaTime;
+    if (!Read(cursor, end, fields) || !Read(cursor, end, deltaTime)) return fail("truncated record");
+    if (!(deltaTime > 0.0f)) return fail("invalid delta time");
+
+    if (fields & FIELD_DISPLAY) {
+        if (!Read(cursor, end, state.displaySize) || !Read(cursor, end, state.framebufferScale)) return fail("truncated record");
+        io.DisplaySize = state.displaySize;
+        io.DisplayFramebufferScale = state.framebufferScale;
+    }
+    if (fields & FIELD_MODS) {
+        uint8_t mods;
+        if (!Read(cursor, end, mods)) return fail("truncated record");
+        for (int i = 0; i < 4; i++) {
+            const bool down = (mods >> i) & 1;
+            if (down != (((state.mods >> i) & 1) != 0)) io.AddKeyEvent(MOD_KEYS[i], down);
+        }
+        state.mods = mods;
+    }
+    if (fields & FIELD_KEYS) {
+        uint16_t count;
+        if (!Read(cursor, end, count)) return fail("truncated record");
+        for (uint16_t i = 0; i < count; i++) {
+            uint16_t value;
+            if (!Read(cursor, end, value)) return fail("truncated record");
+            const int key = ImGuiKey_NamedKey_BEGIN + (value & ~KEY_DOWN_BIT);
+            if (key >= ImGuiKey_NamedKey_END || IsReservedModKey(key)) return fail("invalid key");
+            io.AddKeyEvent(static_cast<ImGuiKey>(key), (value & KEY_DOWN_BIT) != 0);
+        }
+    }
+    if (fields & FIELD_MOUSE_POS) {
+        if (!Read(cursor, end, state.mousePos)) return fail("truncated record");
+        io.AddMousePosEvent(state.mousePos.x, state.mousePos.y);
+    }
+    if (fields & FIELD_MOUSE_BUTTONS) {
+        uint8_t buttons;
+        if (!Read(cursor, end, buttons)) return fail("truncated record");
+        for (int b = 0; b < ImGuiMouseButton_COUNT; b++) {
+            const bool down = (buttons >> b) & 1;
+            if (down != (((state.mouseButtons >> b) & 1) != 0)) io.AddMouseButtonEvent(b, down);
+        }
+        state.mouseButtons = buttons;
+    }
+    if (fields & FIELD_MOUSE_WHEEL) {
+        ImVec2 wheel;
+        if (!Read(cursor, end, wheel)) return fail("truncated record");
+        io.AddMouseWheelEvent(wheel.x, wheel.y);
+    }
+    if (fields & FIELD_TEXT) {
+        uint16_t count;
+        if (!Read(cursor, end, count)) return fail("truncated record");
+        for (uint16_t i = 0; i < count; i++) {
+            uint32_t c;
+            if (!Read(cursor, end, c)) return fail("truncated record");
+            io.AddInputCharacter(c);
+        }
+    }
+    if (!Read(cursor, end, recordedChecksum)) return fail("truncated record");
+
+    io.DeltaTime = deltaTime;
+    frameIndex++;
+    return true;
+}
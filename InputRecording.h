@@ -0,0 +1,83 @@
+#pragma once
+
+#include <imgui.h>
+#include <bitset>
+#include <cfloat>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "LayoutLoader.h"
+
+// 输入录制与回放：录制每帧实际生效的ImGui输入（NewFrame之后的IO状态），
+// 回放时把同样的输入送入无后端的ImGui上下文，逐帧得到相同的UI，用于性能回归和正确性检查。
+//
+// 文件格式（本机字节序）：
+//   RecordingHeader          魔数、版本、录制时的ImGui版本和内容缩放
+//   帧记录 * N               uint16 变化掩码，float deltaTime，按掩码依次出现：
+//                            显示尺寸/帧缓冲缩放、修饰键、按键、鼠标位置、鼠标按钮、滚轮、字符，
+//                            最后是uint64 绘制数据校验和
+// 只记录与上一帧不同的状态，静止的帧只有14字节。格式变化时递增INPUT_RECORDING_VERSION。
+
+constexpr unsigned int INPUT_RECORDING_VERSION = 1;
+
+// 绘制数据校验和（64位FNV-1a）：覆盖顶点、索引、裁剪矩形和命令划分，
+// 不含纹理ID（与渲染后端有关），因此实时窗口和无后端回放的结果可以直接比较
+uint64_t ChecksumDrawData(const ImDrawData* drawData);
+
+// 帧间比较用的输入状态
+struct RecordedInputState {
+    ImVec2 displaySize{ 0.0f, 0.0f };
+    ImVec2 framebufferScale{ 1.0f, 1.0f };
+    ImVec2 mousePos{ -FLT_MAX, -FLT_MAX };
+    unsigned int mouseButtons = 0; // 按位，ImGuiMouseButton_COUNT个按钮
+    unsigned int mods = 0;         // Ctrl/Shift/Alt/Super
+    std::bitset<ImGuiKey_NamedKey_END - ImGuiKey_NamedKey_BEGIN> keys;
+};
+
+// 录制器：NewFrame之后调用BeginFrame，Render之后调用EndFrame
+class InputRecorder {
+public:
+    InputRecorder() = default;
+    ~InputRecorder();
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    bool Open(const std::string& path, float contentScale, std::string* error);
+    void Close();
+    bool IsOpen() const { return file != nullptr; }
+    int GetFrameCount() const { return frameCount; }
+
+    void BeginFrame(const ImGuiIO& io);         // 记录本帧生效的输入
+    void EndFrame(const ImDrawData* drawData);  // 追加校验和并写出本帧记录
+
+private:
+    FILE* file = nullptr;
+    RecordedInputState last;
+    std::vector<unsigned char> record; // 当前帧记录，容量跨帧复用
+    int frameCount = 0;
+};
+
+// 回放器：每帧在NewFrame之前调用NextFrame
+class InputReplayer {
+public:
+    bool Open(const std::string& path, std::string* error);
+
+    float GetContentScale() const { return contentScale; }
+    unsigned int GetImGuiVersion() const { return imguiVersion; } // 录制时的IMGUI_VERSION_NUM
+
+    // 把下一帧的输入送入io，录制结束时返回false（error为空），数据损坏时返回false并给出error
+    bool NextFrame(ImGuiIO& io, std::string* error);
+    uint64_t GetRecordedChecksum() const { return recordedChecksum; } // 当前帧录制时的校验和
+    int GetFrameIndex() const { return frameIndex; }
+
+private:
+    MappedFile file;
+    const char* cursor = nullptr;
+    const char* end = nullptr;
+    RecordedInputState state;
+    float contentScale = 1.0f;
+    unsigned int imguiVersion = 0;
+    uint64_t recordedChecksum = 0;
+    int frameIndex = -1;
+};
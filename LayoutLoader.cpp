@@ -0,0 +1,372 @@
+#include "LayoutLoader.h"
+#include "RegionSnapshot.h"
+#include "FrameScheduler.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+// MappedFile 实现
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::string& path) {
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    size = static_cast<size_t>(fileSize.QuadPart);
+    if (size == 0) return true; // 空文件无法映射
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        Close();
+        return false;
+    }
+    mappingHandle = mapping;
+    data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        Close();
+        return false;
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    size = static_cast<size_t>(st.st_size);
+    if (size > 0) {
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            size = 0;
+            return false;
+        }
+        data = static_cast<const char*>(mapped);
+    }
+    close(fd); // 映射建立后即可关闭文件描述符
+#endif
+    return true;
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mappingHandle) CloseHandle(static_cast<HANDLE>(mappingHandle));
+    if (fileHandle) CloseHandle(static_cast<HANDLE>(fileHandle));
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (data) munmap(const_cast<char*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+// 布局解析
+namespace {
+
+// 从行中取下一个记号，支持双引号
+bool NextToken(std::string_view& line, std::string_view& token, bool* quoted = nullptr) {
+    size_t i = 0;
+    while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) i++;
+    line.remove_prefix(i);
+    if (line.empty() || line[0] == '#') return false;
+
+    if (quoted) *quoted = line[0] == '"';
+    if (line[0] == '"') {
+        size_t close = line.find('"', 1);
+        if (close == std::string_view::npos) close = line.size();
+        token = line.substr(1, close - 1);
+        line.remove_prefix(std::min(close + 1, line.size()));
+        return true;
+    }
+
+    size_t end = 0;
+    while (end < line.size() && line[end] != ' ' && line[end] != '\t' && line[end] != '#') end++;
+    token = line.substr(0, end);
+    line.remove_prefix(end);
+    return true;
+}
+
+bool Fail(std::string* error, size_t lineNo, const char* message) {
+    if (error) {
+        *error = "line " + std::to_string(lineNo) + ": " + message;
+    }
+    return false;
+}
+
+// 解析 weight=/min=/max= 选项，未知选项或数值无效时返回false
+bool ParseOption(std::string_view key, std::string_view value, RegionConstraint& constraint) {
+    float number = 0.0f;
+    const auto result = std::from_chars(value.data(), value.data() + value.size(), number);
+    if (result.ec != std::errc() || result.ptr != value.data() + value.size() || !(number >= 0.0f && number <= FLT_MAX)) return false;
+    if (key == "weight") constraint.weight = number;
+    else if (key == "min") constraint.minSize = number;
+    else if (key == "max") constraint.maxSize = number;
+    else return false;
+    return true;
+}
+
+} // namespace
+
+bool ParseLayout(std::string_view text, RegionTree& tree, IDGenerator& idGen, std::string* error) {
+    tree.Clear();
+    // 每行最多一个区域，先按行数预留空间
+    tree.Reserve(static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) + 2);
+
+    const RegionHandle root = tree.AddRegion(INVALID_REGION, REGION_ROOT, "root", "Root");
+
+    // 当前打开的row/group栈
+    std::vector<RegionHandle> stack;
+    stack.reserve(16);
+
+    size_t lineNo = 0;
+    while (!text.empty()) {
+        lineNo++;
+        size_t eol = text.find('\n');
+        std::string_view line = text.substr(0, eol);
+        text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+        std::string_view keyword;
+        if (!NextToken(line, keyword)) continue; // 空行或注释
+
+        // 位置参数（名称、组ID）之外的 key=value 记号为布局约束
+        std::string_view args[2], token;
+        int argCount = 0;
+        bool quoted = false;
+        bool hasConstraint = false;
+        RegionConstraint constraint;
+        while (NextToken(line, token, &quoted)) {
+            const size_t equals = quoted ? std::string_view::npos : token.find('=');
+            if (equals != std::string_view::npos) {
+                if (!ParseOption(token.substr(0, equals), token.substr(equals + 1), constraint)) {
+                    return Fail(error, lineNo, "invalid option (expected weight=, min= or max= with a non-negative number)");
+                }
+                hasConstraint = true;
+                continue;
+            }
+            if (argCount == 2) return Fail(error, lineNo, "unexpected trailing token");
+            args[argCount++] = token;
+        }
+        const std::string_view name = args[0];
+        const std::string_view groupId = args[1];
+        const bool hasName = argCount >= 1;
+        const bool hasGroup = argCount >= 2;
+        if (hasConstraint && constraint.maxSize < constraint.minSize) return Fail(error, lineNo, "max is less than min");
+
+        const RegionHandle current = stack.empty() ? root : stack.back();
+        RegionHandle added = INVALID_REGION;
+        if (keyword == "end") {
+            if (stack.empty()) return Fail(error, lineNo, "'end' without open row/group");
+            if (hasConstraint) return Fail(error, lineNo, "'end' takes no options");
+            stack.pop_back();
+        }
+        else if (keyword == "row") {
+            if (!stack.empty()) return Fail(error, lineNo, "'row' must be at top level");
+            if (!hasName || hasGroup) return Fail(error, lineNo, "usage: row <name> [options]");
+            added = tree.AddRegion(root, REGION_ROW, idGen.GetID(name), name);
+            stack.push_back(added);
+        }
+        else if (keyword == "group") {
+            if (stack.empty()) return Fail(error, lineNo, "'group' must be inside a row");
+            if (!hasName || !hasGroup) return Fail(error, lineNo, "usage: group <name> <groupId> [options]");
+            added = tree.AddRegion(current, REGION_GROUP, idGen.GetID(name), name, groupId);
+            stack.push_back(added);
+        }
+        else if (keyword == "leaf") {
+            if (stack.empty()) return Fail(error, lineNo, "'leaf' must be inside a row or group");
+            if (!hasName) return Fail(error, lineNo, "usage: leaf <name> [groupId] [options]");
+            // 组内叶子默认继承组ID
+            std::string_view leafGroup = hasGroup ? groupId : tree.groupId[current];
+            added = tree.AddRegion(current, REGION_LEAF, idGen.GetID(name), name, leafGroup);
+        }
+        else {
+            return Fail(error, lineNo, "unknown keyword");
+        }
+        if (hasConstraint) tree.SetConstraint(added, constraint);
+    }
+
+    if (!stack.empty()) return Fail(error, lineNo, "missing 'end'");
+
+    // 成员索引也在后台线程建好
+    tree.BuildMembership();
+    return true;
+}
+
+bool LoadLayoutFile(const std::string& path, RegionTree& tree, std::string* error) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(path)) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    // 快照直接引用映射内存，文本解析后映射即可释放
+    std::string message;
+    bool loaded;
+    if (IsRegionSnapshot(file->View())) {
+        loaded = LoadRegionSnapshot(std::move(file), tree, &message);
+    }
+    else {
+        IDGenerator idGen;
+        loaded = ParseLayout(file->View(), tree, idGen, &message);
+    }
+    if (!loaded && error) *error = path + ": " + message;
+    return loaded;
+}
+
+// LayoutWatcher 实现
+LayoutWatcher::LayoutWatcher(const std::string& path)
+    : path(path) {
+    thread = std::thread(&LayoutWatcher::Run, this);
+}
+
+LayoutWatcher::~LayoutWatcher() {
+    stopping = true;
+    if (thread.joinable()) thread.join();
+    delete pending.exchange(nullptr);
+    FreeRetired();
+}
+
+void LayoutWatcher::RequestReload() {
+    reloadRequested = true;
+}
+
+std::unique_ptr<LayoutLoadResult> LayoutWatcher::TakeResult() {
+    return std::unique_ptr<LayoutLoadResult>(pending.exchange(nullptr, std::memory_order_acquire));
+}
+
+void LayoutWatcher::Retire(std::unique_ptr<RegionTree> oldTree) {
+    // 后台线程还没释放上一棵旧树时也不在这里释放，一并留给后台线程
+    RetiredTree* node = new RetiredTree{ std::move(oldTree), retired.load(std::memory_order_relaxed) };
+    while (!retired.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+
+void LayoutWatcher::Publish(LayoutLoadResult* result) {
+    // 渲染线程还没取走的旧结果直接丢弃
+    delete pending.exchange(result, std::memory_order_acq_rel);
+    FrameScheduler::Wake();
+}
+
+void LayoutWatcher::FreeRetired() {
+    // 整体取走链表，不会与压入方产生ABA问题
+    RetiredTree* node = retired.exchange(nullptr, std::memory_order_acquire);
+    while (node) {
+        RetiredTree* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+void LayoutWatcher::Load() {
+    auto result = new LayoutLoadResult;
+    auto tree = std::make_unique<RegionTree>();
+    if (LoadLayoutFile(path, *tree, &result->error)) {
+        result->tree = std::move(tree);
+    }
+    Publish(result);
+}
+
+void LayoutWatcher::Run() {
+    namespace fs = std::filesystem;
+    const fs::path filePath(path);
+
+#ifdef __linux__
+    // 监视所在目录：编辑器保存时常常是写临时文件再重命名
+    const std::string fileName = filePath.filename().string();
+    std::string dirName = filePath.parent_path().string();
+    if (dirName.empty()) dirName = ".";
+    int notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notifyFd >= 0 && inotify_add_watch(notifyFd, dirName.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        close(notifyFd);
+        notifyFd = -1;
+    }
+    alignas(inotify_event) char buffer[4096];
+#else
+    const int notifyFd = -1;
+#endif
+
+    std::error_code ec;
+    fs::file_time_type lastWrite = fs::last_write_time(filePath, ec);
+    auto changedAt = std::chrono::steady_clock::time_point::max();
+    const auto debounce = std::chrono::milliseconds(50);
+
+    while (!stopping) {
+        FreeRetired();
+
+        bool changed = false;
+#ifdef __linux__
+        if (notifyFd >= 0) {
+            pollfd pfd{ notifyFd, POLLIN, 0 };
+            if (poll(&pfd, 1, 100) > 0) {
+                ssize_t len;
+                while ((len = read(notifyFd, buffer, sizeof(buffer))) > 0) {
+                    for (char* p = buffer; p < buffer + len;) {
+                        auto* event = reinterpret_cast<inotify_event*>(p);
+                        if (event->len > 0 && fileName == event->name) changed = true;
+                        p += sizeof(inotify_event) + event->len;
+                    }
+                }
+            }
+        }
+#endif
+        if (notifyFd < 0) {
+            // 没有inotify时退化为轮询修改时间
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+            fs::file_time_type writeTime = fs::last_write_time(filePath, ec);
+            if (!ec && writeTime != lastWrite) {
+                lastWrite = writeTime;
+                changed = true;
+            }
+        }
+
+        // 连续写入时等文件稳定后再解析
+        const auto now = std::chrono::steady_clock::now();
+        if (changed) changedAt = now;
+        if (changedAt != std::chrono::steady_clock::time_point::max() && now - changedAt >= debounce) {
+            changedAt = std::chrono::steady_clock::time_point::max();
+            reloadRequested = true;
+        }
+
+        if (reloadRequested.exchange(false)) {
+            Load();
+        }
+    }
+
+#ifdef __linux__
+    if (notifyFd >= 0) close(notifyFd);
+#endif
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include "RegionTree.h"
+
+// 布局文件格式（按行解析，#开头为注释，名称含空格时用双引号）：
+//
+//   row Row1
+//       leaf A1
+//       leaf A2
+//   end
+//   row Row2
+//       group "A1 Group" A1
+//           leaf A1B1
+//           leaf A1B2
+//       end
+//   end
+//
+// row <名称>            根区域下的一行
+// group <名称> <组ID>   行或组下的一个组，组内叶子默认继承组ID
+// leaf <名称> [组ID]    行或组下的叶子区域
+// end                   结束最近的row/group
+//
+// row/group/leaf 后面可以跟布局约束选项（尺寸沿父区域的分割方向，默认等分）：
+//   weight=<权重>  分配父区域空间的权重，默认1
+//   min=<像素>     最小尺寸
+//   max=<像素>     最大尺寸
+// 例如 "leaf A1 weight=2 min=120"
+//
+// LayoutWatcher也接受二进制快照文件（见RegionSnapshot.h），按文件头自动识别
+
+// 只读内存映射文件
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+    std::string_view View() const { return std::string_view(data, size); }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+// 解析布局文本到区域树，失败时返回false并给出带行号的错误信息
+bool ParseLayout(std::string_view text, RegionTree& tree, IDGenerator& idGen, std::string* error);
+
+// 同步加载布局文件（文本或快照），失败时返回false并给出带文件名的错误信息
+bool LoadLayoutFile(const std::string& path, RegionTree& tree, std::string* error);
+
+// 加载结果：成功时tree非空，否则error为错误信息
+struct LayoutLoadResult {
+    std::unique_ptr<RegionTree> tree;
+    std::string error;
+};
+
+// 布局文件监视器：后台线程监视文件变化并重新解析，
+// 渲染线程在帧边界通过TakeResult()无锁地取走新树
+class LayoutWatcher {
+public:
+    explicit LayoutWatcher(const std::string& path);
+    ~LayoutWatcher();
+
+    void RequestReload();                          // 强制重新加载（如按F5）
+    std::unique_ptr<LayoutLoadResult> TakeResult(); // 渲染线程调用，不阻塞
+    bool HasResult() const { return pending.load(std::memory_order_relaxed) != nullptr; } // 是否有待取走的结果
+    // 旧树交给后台线程释放（总是压入待释放链表，渲染线程只分配一个链表节点，从不释放树）
+    void Retire(std::unique_ptr<RegionTree> oldTree);
+
+    const std::string& GetPath() const { return path; }
+
+private:
+    void Run();
+    void Load();
+    void Publish(LayoutLoadResult* result);
+    void FreeRetired();
+
+    std::string path;
+    std::thread thread;
+    std::atomic<bool> stopping{ false };
+    std::atomic<bool> reloadRequested{ true }; // 启动时先加载一次
+    std::atomic<LayoutLoadResult*> pending{ nullptr };
+    struct RetiredTree {
+        std::unique_ptr<RegionTree> tree;
+        RetiredTree* next;
+    };
+    std::atomic<RetiredTree*> retired{ nullptr }; // 待释放的旧树（无锁栈，后台线程整体取走）
+};
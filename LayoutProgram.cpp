@@ -0,0 +1,172 @@
+#include "LayoutProgram.h"
+#include <algorithm>
+
+void LayoutProgram::Compile(const RegionTree& tree) {
+    splits.clear();
+    slotRegion.clear();
+    slotWeight.clear();
+    slotMin.clear();
+    slotMax.clear();
+    splitOf.assign(tree.Size(), -1);
+    treeVersion = tree.GetLayoutVersion();
+
+    const RegionHandle root = tree.Root();
+    if (root != INVALID_REGION) {
+        CompileRegion(tree, root);
+    }
+    slotExtent.assign(slotRegion.size(), 0.0f);
+    slotFrozen.assign(slotRegion.size(), 0);
+}
+
+void LayoutProgram::CompileRegion(const RegionTree& tree, RegionHandle region) {
+    const int childCount = tree.childCount[region];
+    if (childCount == 0) return;
+
+    const int index = static_cast<int>(splits.size());
+    splitOf[region] = index;
+
+    LayoutSplit split;
+    split.parent = region;
+    split.firstSlot = static_cast<int>(slotRegion.size());
+    split.childCount = childCount;
+    split.subtreeEnd = index + 1;
+    split.axis = tree.type[region] == REGION_ROOT ? 1 : 0;
+
+    // 权重在编译时归一化，执行时只需乘以可用尺寸
+    const float firstWeight = tree.constraint[tree.firstChild[region]].weight;
+    float weightSum = 0.0f;
+    bool uniform = true;
+    bool constrained = false;
+    for (RegionHandle child = tree.firstChild[region]; child != INVALID_REGION; child = tree.nextSibling[child]) {
+        const RegionConstraint& constraint = tree.constraint[child];
+        slotRegion.push_back(child);
+        slotWeight.push_back(constraint.weight);
+        slotMin.push_back(constraint.minSize);
+        slotMax.push_back(constraint.maxSize);
+        weightSum += constraint.weight;
+        uniform = uniform && constraint.weight == firstWeight;
+        constrained = constrained || constraint.minSize > 0.0f || constraint.maxSize < FLT_MAX;
+    }
+    for (int k = split.firstSlot; k < split.firstSlot + childCount; k++) {
+        slotWeight[k] = weightSum > 0.0f ? slotWeight[k] / weightSum : 1.0f / childCount;
+    }
+    split.mode = constrained ? SPLIT_CONSTRAINED : (uniform ? SPLIT_UNIFORM : SPLIT_WEIGHTED);
+    splits.push_back(split);
+
+    for (RegionHandle child = tree.firstChild[region]; child != INVALID_REGION; child = tree.nextSibling[child]) {
+        CompileRegion(tree, child);
+    }
+    splits[index].subtreeEnd = static_cast<int>(splits.size());
+}
+
+static bool SameRect(const ImVec2& posA, const ImVec2& sizeA, const ImVec2& posB, const ImVec2& sizeB) {
+    return posA.x == posB.x && posA.y == posB.y && sizeA.x == sizeB.x && sizeA.y == sizeB.y;
+}
+
+// 写入区域矩形，变化时标记区域需要重新分割
+static void AssignRect(RegionTree& tree, RegionHandle region, const ImVec2& pos, const ImVec2& size, bool& moved) {
+    if (SameRect(tree.pos[region], tree.size[region], pos, size)) return;
+    tree.pos[region] = pos;
+    tree.size[region] = size;
+    if (tree.childCount[region] > 0) tree.layoutDirty[region] = 1;
+    moved = true;
+}
+
+bool LayoutProgram::PlaceRoot(RegionTree& tree, const ImVec2& pos, const ImVec2& size) const {
+    bool moved = false;
+    const RegionHandle root = tree.Root();
+    if (root != INVALID_REGION) AssignRect(tree, root, pos, size, moved);
+    return moved;
+}
+
+void LayoutProgram::Resolve(const LayoutSplit& split, float total) {
+    const int first = split.firstSlot;
+    const int last = first + split.childCount;
+    const float* weight = slotWeight.data();
+    float* extent = slotExtent.data();
+
+    // 按权重分配（连续数组上的逐元素乘法）
+    for (int k = first; k < last; k++) {
+        extent[k] = total * weight[k];
+    }
+    if (split.mode != SPLIT_CONSTRAINED) return;
+
+    // 与CSS flex相同的约束求解：按剩余权重分配剩余空间并钳制到[min, max]，
+    // 总违反量为正时固定所有被抬到最小值的槽，为负时固定所有被压到最大值的槽，
+    // 再把剩余空间分给其余的槽。每轮至少固定一个槽
+    std::fill(slotFrozen.begin() + first, slotFrozen.begin() + last, 0);
+    float freeSpace = total;
+    for (int pass = 0; pass < split.childCount; pass++) {
+        float freeWeight = 0.0f;
+        for (int k = first; k < last; k++) {
+            if (!slotFrozen[k]) freeWeight += weight[k];
+        }
+
+        float violation = 0.0f;
+        for (int k = first; k < last; k++) {
+            if (slotFrozen[k]) continue;
+            const float target = freeWeight > 0.0f ? freeSpace * weight[k] / freeWeight : 0.0f;
+            extent[k] = std::clamp(target, slotMin[k], slotMax[k]);
+            violation += extent[k] - target;
+        }
+        if (violation == 0.0f) return;
+
+        float frozenSpace = 0.0f;
+        for (int k = first; k < last; k++) {
+            if (slotFrozen[k]) continue;
+            const float target = freeWeight > 0.0f ? freeSpace * weight[k] / freeWeight : 0.0f;
+            if (violation > 0.0f ? extent[k] > target : extent[k] < target) {
+                slotFrozen[k] = 1;
+                frozenSpace += extent[k];
+            }
+        }
+        freeSpace -= frozenSpace;
+    }
+}
+
+bool LayoutProgram::Run(RegionTree& tree, int begin, int end) {
+    bool moved = false;
+    for (int i = begin; i < end; i++) {
+        const LayoutSplit& split = splits[i];
+        const RegionHandle parent = split.parent;
+        if (!tree.layoutDirty[parent]) continue;
+        tree.layoutDirty[parent] = 0;
+
+        const ImVec2 pos = tree.pos[parent];
+        const ImVec2 size = tree.size[parent];
+        const int first = split.firstSlot;
+        const int count = split.childCount;
+
+        if (split.mode == SPLIT_UNIFORM) {
+            // 等分：与原先的逐项公式相同，结果逐位不变
+            if (split.axis == 0) {
+                const float childWidth = size.x / count;
+                for (int k = 0; k < count; k++) {
+                    AssignRect(tree, slotRegion[first + k], { pos.x + k * childWidth, pos.y }, { childWidth, size.y }, moved);
+                }
+            }
+            else {
+                const float rowHeight = size.y / count;
+                for (int k = 0; k < count; k++) {
+                    AssignRect(tree, slotRegion[first + k], { pos.x, pos.y + k * rowHeight }, { size.x, rowHeight }, moved);
+                }
+            }
+            continue;
+        }
+
+        // 按权重（和约束）分配后依次排开
+        Resolve(split, split.axis == 0 ? size.x : size.y);
+        float offset = split.axis == 0 ? pos.x : pos.y;
+        for (int k = first; k < first + count; k++) {
+            const float extent = slotExtent[k];
+            if (split.axis == 0) {
+                AssignRect(tree, slotRegion[k], { offset, pos.y }, { extent, size.y }, moved);
+            }
+            else {
+                AssignRect(tree, slotRegion[k], { pos.x, offset }, { size.x, extent }, moved);
+            }
+            offset += extent;
+        }
+    }
+    return moved;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include "RegionTree.h"
+
+// 编译后的布局程序：区域树按先序编译为扁平的分割指令数组，每条指令把一个区域的矩形
+// 沿一个方向（根区域垂直，其他水平）分给它的子区域，子区域的权重和约束存放在连续的槽数组中。
+//
+// 父区域的指令总在子区域之前，因此一遍顺序执行即可完成布局；任一子树的指令是连续的一段，
+// 不同子树的区段可以由不同线程同时执行。只有父区域layoutDirty的指令会执行，
+// 子区域矩形变化时再标记子区域，未变化的子树只付出一次标记检查。
+// 树结构或约束变化后需要重新编译（Compile），每帧只执行（Run）。
+class LayoutProgram {
+public:
+    void Compile(const RegionTree& tree);
+    unsigned int GetTreeVersion() const { return treeVersion; } // 编译时树的布局版本
+
+    // 设置根区域的矩形，返回根区域是否移动
+    bool PlaceRoot(RegionTree& tree, const ImVec2& pos, const ImVec2& size) const;
+    // 执行[begin, end)的指令，返回是否有区域移动
+    bool Run(RegionTree& tree, int begin, int end);
+
+    int GetSplitCount() const { return static_cast<int>(splits.size()); }
+    int FindSplit(RegionHandle region) const { return splitOf[region]; } // 没有子区域时为-1
+    int GetSubtreeEnd(int split) const { return splits[split].subtreeEnd; } // 子树指令区段的结尾
+
+private:
+    enum SplitMode : unsigned char {
+        SPLIT_UNIFORM,      // 等分（与原先的等分布局逐位相同）
+        SPLIT_WEIGHTED,     // 按归一化权重分配
+        SPLIT_CONSTRAINED,  // 按权重分配，再满足最小/最大尺寸
+    };
+
+    // 分割指令：把parent的矩形分给[firstSlot, firstSlot + childCount)槽中的子区域
+    struct LayoutSplit {
+        RegionHandle parent;
+        int firstSlot;
+        int childCount;
+        int subtreeEnd;     // parent子树最后一条指令之后的下标
+        unsigned char axis; // 0水平分割，1垂直分割
+        SplitMode mode;
+    };
+
+    void CompileRegion(const RegionTree& tree, RegionHandle region);
+    void Resolve(const LayoutSplit& split, float total);
+
+    std::vector<LayoutSplit> splits;
+    std::vector<int> splitOf;              // 区域 -> 指令下标
+
+    // 槽数组，按指令连续存放
+    std::vector<RegionHandle> slotRegion;
+    std::vector<float> slotWeight;         // 归一化权重，同一指令内和为1
+    std::vector<float> slotMin;
+    std::vector<float> slotMax;
+    std::vector<float> slotExtent;         // 执行时的分配结果
+    std::vector<unsigned char> slotFrozen; // 约束求解时已固定尺寸的槽
+
+    unsigned int treeVersion = 0;
+};
@@ -0,0 +1,325 @@
+#include "LogSink.h"
+#include "MpscQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::system_clock;
+
+// 固定大小的记录，整条构造在队列槽中
+struct LogRecord {
+    long long time;         // 入队时间（system_clock微秒）
+    unsigned short length;
+    char text[LogSink::MAX_RECORD_LENGTH];
+};
+
+constexpr size_t BATCH_BYTES = 64 * 1024; // 攒够后写出一次
+
+struct SinkState;
+void Stop(SinkState& state);
+
+struct SinkState {
+    MpscQueue<LogRecord, LogSink::QUEUE_CAPACITY> queue;
+    std::atomic<size_t> dropped{ 0 };
+    std::atomic<size_t> written{ 0 };
+
+    // 以下由mutex保护
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable flushed;
+    std::thread writer;
+    bool running = false;
+    bool stopping = false;
+    unsigned long long flushRequested = 0;
+    unsigned long long flushCompleted = 0;
+
+    // 以下仅后台线程访问
+    LogSinkConfig config;
+    FILE* file = nullptr;
+    size_t fileBytes = 0;
+    Clock::time_point fileOpened;
+    std::string batch;
+    size_t reportedDrops = 0;
+    bool renamePending = false;   // 轮转时改名失败，file仍是追加打开的path，每批写出前重试轮转
+    bool rotatePending = false;   // 轮转后新文件没能打开，file仍是轮转出去的旧文件，每批写出前重试
+    std::string rotatedPath;      // 轮转出去的旧文件
+    bool rotateFailureReported = false;
+
+    ~SinkState() { Stop(*this); } // 程序退出时写出剩余的记录
+};
+
+SinkState& GetState() {
+    static SinkState state;
+    return state;
+}
+
+long long NowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// "2024-01-02 03:04:05.678 "
+void AppendTimestamp(std::string& out, long long micros) {
+    const std::time_t seconds = static_cast<std::time_t>(micros / 1000000);
+    std::tm local;
+#ifdef _WIN32
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+    char buffer[32];
+    const int length = std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d.%03d ",
+        local.tm_year + 1900, local.tm_mon + 1, local.tm_mday, local.tm_hour, local.tm_min, local.tm_sec,
+        static_cast<int>((micros / 1000) % 1000));
+    out.append(buffer, static_cast<size_t>(length));
+}
+
+bool OpenFile(SinkState& state, const std::string& path, const char* mode) {
+    state.file = std::fopen(path.c_str(), mode);
+    if (!state.file) return false;
+    std::fseek(state.file, 0, SEEK_END);
+    const long size = std::ftell(state.file);
+    state.fileBytes = size > 0 ? static_cast<size_t>(size) : 0;
+    state.fileOpened = Clock::now();
+    return true;
+}
+
+// 把path.1 ...依次后移一位，再把path改名为path.1。只后移到第一个空位为止（没有空位时删除path.maxFiles），
+// 改名失败后重试不会再删掉更早的历史文件
+bool ShiftHistory(const std::string& path, int maxFiles) {
+    namespace fs = std::filesystem;
+    auto historyPath = [&](int i) { return path + "." + std::to_string(i); };
+    std::error_code ec;
+    int free = 1;
+    while (free <= maxFiles && fs::exists(historyPath(free), ec)) free++;
+    if (free > maxFiles) {
+        free = maxFiles;
+        fs::remove(historyPath(maxFiles), ec);
+        if (ec) return false;
+    }
+    for (int i = free - 1; i >= 1; i--) {
+        fs::rename(historyPath(i), historyPath(i + 1), ec);
+        if (ec) return false;
+    }
+    fs::rename(path, historyPath(1), ec);
+    return !ec;
+}
+
+void ReportRotateFailure(SinkState& state, const char* what, const std::string& path) {
+    if (state.rotateFailureReported) return;
+    state.rotateFailureReported = true;
+    std::fprintf(stderr, "LogSink: %s %s during rotation, retrying on the next batch\n", what, path.c_str());
+}
+
+// path -> path.1 -> ... -> path.maxFiles，然后重新打开空的path。失败时记录不丢失，每批写出前重试：
+//   改名失败      -> path仍是正在写的日志，以追加方式重新打开（不能用"wb"，会清空它），下次重试整个轮转
+//   新的path打不开 -> 继续追加到轮转出去的旧文件，下次只重试打开path，不再重复改名
+// 失败只向stderr报告一次，轮转成功后才会再次报告
+void Rotate(SinkState& state) {
+    const std::string& path = state.config.path;
+    if (!state.rotatePending) {
+        // 先关闭再改名（Windows上不能改名已打开的文件）
+        if (state.file) std::fclose(state.file);
+        state.file = nullptr;
+        state.rotatedPath = path;
+        if (state.config.maxFiles > 0) {
+            if (!ShiftHistory(path, state.config.maxFiles)) {
+                state.renamePending = true;
+                ReportRotateFailure(state, "cannot rename", path);
+                if (!OpenFile(state, path, "ab")) {
+                    std::fprintf(stderr, "LogSink: cannot reopen %s, log records are not written to a file\n", path.c_str());
+                }
+                return;
+            }
+            state.renamePending = false;
+            state.rotatedPath = path + ".1";
+        }
+    }
+
+    FILE* previous = state.file;
+    const size_t previousBytes = state.fileBytes;
+    if (OpenFile(state, path, "wb")) {
+        if (previous) std::fclose(previous);
+        state.rotatePending = false;
+        state.rotateFailureReported = false;
+        return;
+    }
+
+    state.rotatePending = true;
+    ReportRotateFailure(state, "cannot open", path);
+    if (previous) {
+        state.file = previous;
+        state.fileBytes = previousBytes;
+    }
+    else if (!OpenFile(state, state.rotatedPath, "ab")) {
+        std::fprintf(stderr, "LogSink: cannot reopen %s, log records are not written to a file\n", state.rotatedPath.c_str());
+    }
+}
+
+void WriteBatch(SinkState& state) {
+    if (state.batch.empty()) return;
+    if (state.rotatePending || state.renamePending) {
+        Rotate(state);
+    }
+    else if (state.file) {
+        const LogSinkConfig& config = state.config;
+        const bool full = config.maxFileBytes > 0 && state.fileBytes + state.batch.size() > config.maxFileBytes;
+        const bool expired = config.rotateSeconds > 0 && Clock::now() - state.fileOpened >= std::chrono::seconds(config.rotateSeconds);
+        if (state.fileBytes > 0 && (full || expired)) Rotate(state);
+    }
+    if (state.file) {
+        std::fwrite(state.batch.data(), 1, state.batch.size(), state.file);
+        std::fflush(state.file);
+        state.fileBytes += state.batch.size();
+    }
+    if (state.config.mirrorToStdout) {
+        std::fwrite(state.batch.data(), 1, state.batch.size(), stdout);
+        std::fflush(stdout);
+    }
+    state.batch.clear();
+}
+
+// 取出队列中的全部记录，攒成大块写出
+void Drain(SinkState& state) {
+    size_t count;
+    do {
+        count = state.queue.consume([&](LogRecord&& record) {
+            AppendTimestamp(state.batch, record.time);
+            state.batch.append(record.text, record.length);
+            state.batch.push_back('\n');
+            if (state.batch.size() >= BATCH_BYTES) WriteBatch(state);
+        }, LogSink::QUEUE_CAPACITY);
+        state.written.fetch_add(count, std::memory_order_relaxed);
+    } while (count > 0);
+
+    const size_t dropped = state.dropped.load(std::memory_order_relaxed);
+    if (dropped != state.reportedDrops) {
+        AppendTimestamp(state.batch, NowMicros());
+        state.batch += "(" + std::to_string(dropped - state.reportedDrops) + " log records dropped)\n";
+        state.reportedDrops = dropped;
+    }
+    WriteBatch(state);
+}
+
+void WriterMain(SinkState& state) {
+    const auto interval = std::chrono::milliseconds(state.config.flushIntervalMs > 0 ? state.config.flushIntervalMs : 1);
+    for (;;) {
+        unsigned long long request;
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(state.mutex);
+            state.wake.wait_for(lock, interval, [&] {
+                return state.stopping || state.flushRequested != state.flushCompleted;
+            });
+            request = state.flushRequested;
+            stop = state.stopping;
+        }
+
+        Drain(state);
+
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.flushCompleted = request;
+        }
+        state.flushed.notify_all();
+        if (stop) return;
+    }
+}
+
+// 通知后台线程写出剩余记录并等待其退出
+void Stop(SinkState& state) {
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (!state.running) return;
+        state.stopping = true;
+    }
+    state.wake.notify_one();
+    state.writer.join();
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.running = false;
+    state.stopping = false;
+    state.renamePending = false;
+    state.rotatePending = false;
+    state.rotateFailureReported = false;
+    if (state.file) {
+        std::fclose(state.file);
+        state.file = nullptr;
+    }
+}
+
+bool PushRecord(SinkState& state, const LogRecord& record) {
+    if (state.queue.tryPush(record)) return true;
+    state.dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+} // namespace
+
+bool LogSink::Open(const LogSinkConfig& config, std::string* error) {
+    Close();
+    SinkState& state = GetState();
+    state.config = config;
+    if (!OpenFile(state, config.path, "ab")) {
+        if (error) *error = "cannot open " + config.path;
+        return false;
+    }
+    state.batch.reserve(BATCH_BYTES + MAX_RECORD_LENGTH + 64);
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.running = true;
+    state.stopping = false;
+    state.writer = std::thread(WriterMain, std::ref(state));
+    return true;
+}
+
+void LogSink::Close() {
+    Stop(GetState());
+}
+
+bool LogSink::Write(std::string_view text) {
+    LogRecord record;
+    record.time = NowMicros();
+    record.length = static_cast<unsigned short>(std::min(text.size(), MAX_RECORD_LENGTH));
+    std::memcpy(record.text, text.data(), record.length);
+    return PushRecord(GetState(), record);
+}
+
+bool LogSink::Writef(const char* format, ...) {
+    LogRecord record;
+    record.time = NowMicros();
+    va_list args;
+    va_start(args, format);
+    const int length = std::vsnprintf(record.text, sizeof(record.text), format, args);
+    va_end(args);
+    if (length < 0) return false;
+    // vsnprintf会写入结尾的'\0'，截断时丢掉最后一个字符
+    record.length = static_cast<unsigned short>(std::min(static_cast<size_t>(length), MAX_RECORD_LENGTH - 1));
+    return PushRecord(GetState(), record);
+}
+
+void LogSink::Flush() {
+    SinkState& state = GetState();
+    std::unique_lock<std::mutex> lock(state.mutex);
+    if (!state.running) return;
+    const unsigned long long request = ++state.flushRequested;
+    state.wake.notify_one();
+    state.flushed.wait(lock, [&] { return state.flushCompleted >= request || !state.running; });
+}
+
+size_t LogSink::GetDroppedCount() {
+    return GetState().dropped.load(std::memory_order_relaxed);
+}
+
+size_t LogSink::GetWrittenCount() {
+    return GetState().written.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// 异步日志：任意线程把格式化好的记录写入无锁队列（不阻塞、不分配内存），
+// 后台线程定期批量取出，加上时间戳后整块写入日志文件（可同时输出到stdout）。
+// 磁盘慢或stdout管道阻塞只会拖住后台线程，队列满时丢弃新记录并计数，不会卡住帧。
+//
+// 日志文件超过maxFileBytes或打开超过rotateSeconds秒后轮转：
+//   path -> path.1 -> path.2 ... -> path.maxFiles（最旧的删除）
+// Close()（或程序退出时）会写出所有已入队的记录后再返回。
+// Open之前写入的记录留在队列中，Open后一并写出。
+
+struct LogSinkConfig {
+    std::string path = "ImGuiDemo.log";
+    size_t maxFileBytes = 4 * 1024 * 1024;  // 按大小轮转，0表示不限制
+    int rotateSeconds = 0;                   // 按时间轮转，0表示不限制
+    int maxFiles = 5;                        // 保留的旧文件数
+    int flushIntervalMs = 100;               // 后台线程的批量间隔
+    bool mirrorToStdout = true;              // 同时输出到stdout
+};
+
+class LogSink {
+public:
+    static constexpr size_t MAX_RECORD_LENGTH = 240;  // 每条记录的最大长度（超出部分截断）
+    static constexpr size_t QUEUE_CAPACITY = 4096;    // 队列容量，满了丢弃新记录
+
+    // 打开日志文件并启动后台线程，已打开时先关闭
+    static bool Open(const LogSinkConfig& config, std::string* error = nullptr);
+    // 写出所有已入队的记录并停止后台线程
+    static void Close();
+
+    // 入队一条记录（任意线程），队列满时返回false
+    static bool Write(std::string_view text);
+    static bool Writef(const char* format, ...);
+
+    // 阻塞直到此前入队的记录都已写入文件（未打开时立即返回）
+    static void Flush();
+
+    static size_t GetDroppedCount();   // 因队列满被丢弃的记录数
+    static size_t GetWrittenCount();   // 已写出的记录数
+};
@@ -0,0 +1,119 @@
+// LogSinkTest.cpp
+// 日志轮转测试：按大小轮转后记录按顺序分布在各文件中且不丢失；
+// 轮转时改名失败（path.1被非空目录占住）不会清空正在写的日志，占用解除后下一批重试轮转成功。
+// 由ctest运行（见CMakeLists.txt）。
+//
+// 用法: LogSinkTest [临时目录]
+
+#include "LogSink.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace fs = std::filesystem;
+
+static int failures = 0;
+
+static void Check(bool condition, const char* what) {
+    std::printf("%s: %s\n", condition ? "ok  " : "FAIL", what);
+    if (!condition) failures++;
+}
+
+static std::string ReadFile(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static LogSinkConfig MakeConfig(const fs::path& path, size_t maxFileBytes, int maxFiles) {
+    LogSinkConfig config;
+    config.path = path.string();
+    config.maxFileBytes = maxFileBytes;
+    config.maxFiles = maxFiles;
+    config.mirrorToStdout = false;
+    return config;
+}
+
+static void WriteRecord(const char* text) {
+    LogSink::Write(text);
+    LogSink::Flush();
+}
+
+// 每条记录单独一批，记录从最旧的文件到path依次排列
+static void TestRotationOrder(const fs::path& dir) {
+    const fs::path path = dir / "order.log";
+    if (!LogSink::Open(MakeConfig(path, 100, 20))) {
+        Check(false, "open order.log");
+        return;
+    }
+    for (int i = 0; i < 10; i++) {
+        char text[64];
+        std::snprintf(text, sizeof(text), "record %02d ----------------------------------------", i);
+        WriteRecord(text);
+    }
+    LogSink::Close();
+
+    std::string all;
+    for (int i = 20; i >= 1; i--) {
+        all += ReadFile(path.string() + "." + std::to_string(i));
+    }
+    all += ReadFile(path);
+    bool ordered = true;
+    size_t position = 0;
+    for (int i = 0; i < 10 && ordered; i++) {
+        char text[16];
+        std::snprintf(text, sizeof(text), "record %02d", i);
+        position = all.find(text, position);
+        ordered = position != std::string::npos;
+    }
+    Check(ordered, "rotated records keep their order and none are lost");
+    Check(fs::exists(path.string() + ".1"), "size rotation produced history files");
+}
+
+// path.1是非空目录：删除和改名都会失败，path必须以追加方式继续写
+static void TestRenameFailure(const fs::path& dir) {
+    const fs::path path = dir / "app.log";
+    const fs::path blocker = path.string() + ".1";
+    const std::string existing(100, 'x');
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << existing << '\n';
+    }
+    fs::create_directory(blocker);
+    std::ofstream(blocker / "keep").put('k');
+
+    if (!LogSink::Open(MakeConfig(path, 150, 1))) {
+        Check(false, "open app.log");
+        return;
+    }
+    WriteRecord("first record after the blocked rotation -------------------------------------");
+    const std::string blocked = ReadFile(path);
+    Check(blocked.compare(0, existing.size(), existing) == 0, "failed rename keeps the existing log");
+    Check(blocked.find("first record") != std::string::npos, "failed rename appends the new record");
+
+    // 占用解除后下一批重试轮转
+    fs::remove_all(blocker);
+    WriteRecord("second record after the blocker is gone");
+    LogSink::Close();
+
+    const std::string rotated = ReadFile(blocker);
+    const std::string current = ReadFile(path);
+    Check(rotated.compare(0, existing.size(), existing) == 0 && rotated.find("first record") != std::string::npos,
+        "retried rotation moves the old log to path.1");
+    Check(current.find("second record") != std::string::npos && current.find("first record") == std::string::npos,
+        "retried rotation starts a fresh path");
+}
+
+int main(int argc, char** argv) {
+    const fs::path dir = argc > 1 ? argv[1] : "LogSinkTest.dir";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+
+    TestRotationOrder(dir);
+    TestRenameFailure(dir);
+
+    fs::remove_all(dir, ec);
+    return failures == 0 ? 0 : 1;
+}
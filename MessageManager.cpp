@@ -1,23 +1,116 @@
-// MessageManager.cpp
-#include "MessageManager.h"
-#include <imgui.h>
-
-void MessageManager::addMessage(const std::string& message) {
-    getMessages().push_back(message);
-}
-
-void MessageManager::clearMessages() {
-    getMessages().clear();
-}
-
-void MessageManager::renderMessages() {
-    auto& messages = getMessages();
-    for (const auto& msg : messages) {
-        ImGui::Text("%s", msg.c_str());
-    }
-}
-
-std::vector<std::string>& MessageManager::getMessages() {
-    static std::vector<std::string> messages;
-    return messages;
-}
\ No newline at end of file
+// MessageManager.cpp
+#include "MessageManager.h"
+#include "LogSink.h"
+#include <imgui.h>
+#include <cstring>
+
+struct MessageManager::Context {
+    MessageLog log;
+};
+
+namespace {
+thread_local MessageManager::Context* t_currentContext = nullptr;
+}
+
+MessageManager::Context* MessageManager::createContext() {
+    return new Context();
+}
+
+void MessageManager::destroyContext(Context* context) {
+    if (t_currentContext == context) {
+        t_currentContext = nullptr;
+    }
+    delete context;
+}
+
+void MessageManager::setCurrentContext(Context* context) {
+    t_currentContext = context;
+}
+
+MessageManager::Context* MessageManager::getCurrentContext() {
+    return t_currentContext;
+}
+
+void MessageManager::addMessage(std::string_view message) {
+    // 同时写入日志文件（异步，不阻塞）
+    LogSink::Write(message);
+
+    auto& log = getLog();
+
+    // 缓冲区满时复用最旧消息的槽
+    size_t slot;
+    if (log.count == MAX_MESSAGES) {
+        slot = log.head;
+        log.head = (log.head + 1) % MAX_MESSAGES;
+        log.dropped++;
+    }
+    else {
+        slot = (log.head + log.count) % MAX_MESSAGES;
+        log.count++;
+    }
+
+    size_t length = message.size();
+    if (length > SLOT_SIZE) {
+        length = SLOT_SIZE;
+        log.truncated++;
+    }
+    memcpy(log.arena + slot * SLOT_SIZE, message.data(), length);
+    log.lengths[slot] = static_cast<unsigned short>(length);
+    log.added++;
+}
+
+void MessageManager::clearMessages() {
+    auto& log = getLog();
+    log.head = 0;
+    log.count = 0;
+}
+
+void MessageManager::renderMessages() {
+    auto& log = getLog();
+    if (log.dropped > 0) {
+        ImGui::TextDisabled("(%zu older messages dropped)", log.dropped);
+    }
+
+    ImGui::BeginChild("##messages", ImVec2(0, 0), true);
+
+    // 只提交可见的行
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(log.count));
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+            std::string_view msg = getMessage(log, i);
+            ImGui::TextUnformatted(msg.data(), msg.data() + msg.size());
+        }
+    }
+    clipper.End();
+
+    // 停在底部时跟随新消息滚动
+    if (log.added != log.rendered && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
+        ImGui::SetScrollHereY(1.0f);
+    }
+    log.rendered = log.added;
+
+    ImGui::EndChild();
+}
+
+size_t MessageManager::getMessageCount() {
+    return getLog().count;
+}
+
+size_t MessageManager::getDroppedCount() {
+    return getLog().dropped;
+}
+
+size_t MessageManager::getTruncatedCount() {
+    return getLog().truncated;
+}
+
+MessageManager::MessageLog& MessageManager::getLog() {
+    static Context defaultContext;
+    return t_currentContext ? t_currentContext->log : defaultContext.log;
+}
+
+std::string_view MessageManager::getMessage(const MessageLog& log, size_t index) {
+    const size_t slot = (log.head + index) % MAX_MESSAGES;
+    return std::string_view(log.arena + slot * SLOT_SIZE, log.lengths[slot]);
+}
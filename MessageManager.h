@@ -1,15 +1,41 @@
-// MessageManager.h
-#pragma once
-#include <string>
-#include <vector>
-#include <functional>
-
-class MessageManager {
-public:
-    static void addMessage(const std::string& message);
-    static void clearMessages();
-    static void renderMessages();
-
-private:
-    static std::vector<std::string>& getMessages();
-};
+// MessageManager.h
+#pragma once
+#include <string_view>
+#include <cstddef>
+
+class MessageManager {
+public:
+    // 消息上下文：一个环形消息缓冲。以下静态接口都作用于调用线程的当前上下文（未设置时为默认上下文）
+    struct Context;
+    static Context* createContext();
+    static void destroyContext(Context* context);
+    static void setCurrentContext(Context* context); // nullptr表示默认上下文
+    static Context* getCurrentContext();
+
+    static constexpr size_t MAX_MESSAGES = 1024;  // 环形缓冲容量，满了丢弃最旧的消息
+    static constexpr size_t SLOT_SIZE = 256;      // 每条消息的槽大小（超出部分截断）
+
+    static void addMessage(std::string_view message); // 同时写入LogSink
+    static void clearMessages();
+    static void renderMessages();
+
+    static size_t getMessageCount();
+    static size_t getDroppedCount();   // 因缓冲区满被覆盖的消息数
+    static size_t getTruncatedCount(); // 被截断的消息数
+
+private:
+    // 固定容量的环形缓冲，所有消息存放在一块预分配的字符串区中
+    struct MessageLog {
+        char arena[MAX_MESSAGES * SLOT_SIZE];
+        unsigned short lengths[MAX_MESSAGES];
+        size_t head = 0;  // 最旧消息的位置
+        size_t count = 0;
+        size_t dropped = 0;
+        size_t truncated = 0;
+        size_t added = 0; // 累计添加的消息数（用于自动滚动）
+        size_t rendered = 0; // 上次绘制时的added
+    };
+
+    static MessageLog& getLog();
+    static std::string_view getMessage(const MessageLog& log, size_t index);
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+// 有界无锁多生产者单消费者队列（基于每个槽的序号，参考Vyukov的有界队列）
+// tryPush可在任意线程调用；consume只能由唯一的消费者线程调用。
+template<typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MpscQueue() {
+        for (size_t i = 0; i < Capacity; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpscQueue() {
+        consume([](T&&) {}, Capacity);
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // 入队，队列满时返回false（不阻塞）
+    template<typename U>
+    bool tryPush(U&& value) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & (Capacity - 1)];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                // 槽空闲，抢占写入位置
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0) {
+                return false; // 队列已满
+            }
+            else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        new (cell->storage) T(std::forward<U>(value));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 依次取出最多maxCount个元素交给func处理，返回处理的个数（仅消费者线程）
+    // 遇到已占位但尚未写完的槽时停止，留到下次处理
+    template<typename Func>
+    size_t consume(Func&& func, size_t maxCount) {
+        size_t processed = 0;
+        while (processed < maxCount) {
+            Cell& cell = cells[dequeuePos & (Capacity - 1)];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence != dequeuePos + 1) break; // 空或写入未完成
+
+            T* value = std::launder(reinterpret_cast<T*>(cell.storage));
+            func(std::move(*value));
+            value->~T();
+            cell.sequence.store(dequeuePos + Capacity, std::memory_order_release);
+            dequeuePos++;
+            processed++;
+        }
+        dequeueCount.store(dequeuePos, std::memory_order_relaxed);
+        return processed;
+    }
+
+    // 近似长度（并发时仅供统计）
+    size_t sizeApprox() const {
+        const size_t enqueued = enqueuePos.load(std::memory_order_relaxed);
+        const size_t dequeued = dequeueCount.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    Cell cells[Capacity];
+    alignas(64) std::atomic<size_t> enqueuePos{ 0 };
+    alignas(64) size_t dequeuePos = 0;           // 仅消费者访问
+    std::atomic<size_t> dequeueCount{ 0 };       // 出队位置的副本，供sizeApprox读取
+};
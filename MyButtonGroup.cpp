@@ -1,156 +1,365 @@
-#include "MyButtonGroup.h"
-
-MyButtonGroup::MyButtonGroup(const std::string& groupName,
-    const std::vector<ButtonConfig>& buttonConfigs)
-    : groupName(groupName) {
-    for (const auto& config : buttonConfigs) {
-        buttons.push_back({
-            std::get<0>(config),  // name
-            std::get<1>(config),  // widthRatio
-            std::get<2>(config),  // callback
-            false                 // isHighlighted
-            });
-    }
-}
-
-void MyButtonGroup::render() {
-    ImGui::PushID(groupName.c_str());
-
-    // ȡÿȣǹȣ
-    float totalWidth = ImGui::GetContentRegionAvail().x - ImGui::GetStyle().ScrollbarSize;
-    float spacing = ImGui::GetStyle().ItemSpacing.x;
-    int buttonCount = static_cast<int>(buttons.size());
-
-    // ܱ
-    float totalRatio = 0.0f;
-    for (const auto& btn : buttons) {
-        totalRatio += btn.widthRatio;
-    }
-
-    // ÿȣȥࣩ
-    float availableWidth = totalWidth - spacing * (buttonCount - 1);
-
-    // Ԥÿťؿȣʹ
-    std::vector<float> buttonWidths;
-    float usedWidth = 0.0f;
-    for (int i = 0; i < buttonCount - 1; ++i) {
-        float width = (buttons[i].widthRatio / totalRatio) * availableWidth;
-        width = std::floor(width); // ʹ
-        buttonWidths.push_back(width);
-        usedWidth += width;
-    }
-    // һťʹʣȣȷܿ׼ȷ
-    float lastWidth = availableWidth - usedWidth;
-    buttonWidths.push_back(lastWidth);
-
-    // Ⱦť
-    for (int i = 0; i < buttonCount; ++i) {
-        auto& btn = buttons[i];
-        float width = buttonWidths[i];
-        ImVec2 buttonSize(width, 40);
-
-        // ȡǰλ
-        ImVec2 cursorPos = ImGui::GetCursorScreenPos();
-        ImVec2 rectMin = cursorPos;
-        ImVec2 rectMax(cursorPos.x + width, cursorPos.y + buttonSize.y);
-
-        // ɫ
-        ImVec4 color = btn.isHighlighted ? HIGHLIGHT_COLOR : NORMAL_COLOR;
-        if (ImGui::IsMouseHoveringRect(rectMin, rectMax)) {
-            color = btn.isHighlighted ?
-                ImVec4(HIGHLIGHT_COLOR.x * 0.9f, HIGHLIGHT_COLOR.y * 0.9f, HIGHLIGHT_COLOR.z * 0.8f, 1.0f) :
-                HOVER_COLOR;
-        }
-
-        ImGui::PushStyleColor(ImGuiCol_Button, color);
-        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, color);
-        ImGui::PushStyleColor(ImGuiCol_ButtonActive, color);
-
-        // Ⱦť
-        if (ImGui::Button(btn.name.c_str(), buttonSize)) {
-            // ťĸ
-            for (auto& b : buttons) {
-                b.isHighlighted = false;
-            }
-            btn.isHighlighted = true;
-            if (btn.callback) {
-                btn.callback();
-            }
-        }
-
-        ImGui::PopStyleColor(3);
-
-        // ͬһȾһť󲻼ӣ
-        if (i < buttonCount - 1) {
-            ImGui::SameLine(0.0f, spacing);
-        }
-    }
-
-    ImGui::PopID();
-}
-
-void MyButtonGroup::setHighlight(const std::string& buttonName) {
-    for (auto& btn : buttons) {
-        btn.isHighlighted = (btn.name == buttonName);
-    }
-}
-
-void MyButtonGroup::clickButton(const std::string& buttonName) {
-    for (auto& btn : buttons) {
-        if (btn.name == buttonName) {
-            // ťĸ
-            for (auto& b : buttons) {
-                b.isHighlighted = false;
-            }
-            btn.isHighlighted = true;
-            if (btn.callback) {
-                btn.callback();
-            }
-            break;
-        }
-    }
-}
-
-// MyButtonManager ʵ
-void MyButtonManager::addGroup(MyButtonGroup* group) {
-    getGroups()[group->getGroupName()] = group;
-}
-
-void MyButtonManager::clickButton(const std::string& groupName, const std::string& buttonName) {
-    auto& groups = getGroups();
-    auto it = groups.find(groupName);
-    if (it != groups.end()) {
-        it->second->clickButton(buttonName);
-    }
-}
-
-void MyButtonManager::setHighlight(const std::string& groupName, const std::string& buttonName) {
-    auto& groups = getGroups();
-    auto it = groups.find(groupName);
-    if (it != groups.end()) {
-        it->second->setHighlight(buttonName);
-    }
-}
-
-std::unordered_map<std::string, MyButtonGroup*>& MyButtonManager::getGroups() {
-    static std::unordered_map<std::string, MyButtonGroup*> groups;
-    return groups;
-}
-
-// ӳٻصʵ
-void MyButtonManager::deferUIUpdate(const std::function<void()>& action) {
-    getDeferredQueue().push(action);
-}
-
-void MyButtonManager::processDeferredUpdates() {
-    auto& queue = getDeferredQueue();
-    while (!queue.empty()) {
-        queue.front()();
-        queue.pop();
-    }
-}
-
-std::queue<std::function<void()>>& MyButtonManager::getDeferredQueue() {
-    static std::queue<std::function<void()>> deferredQueue;
-    return deferredQueue;
-}
+#include "MyButtonGroup.h"
+#include "Profiler.h"
+#include "AllocationTracker.h"
+#include "ImGuiThreading.h"
+#include "FrameScheduler.h"
+#include <imgui_internal.h>
+#include <algorithm>
+
+MyButtonGroup::MyButtonGroup(const std::string& groupName,
+    const std::vector<ButtonConfig>& buttonConfigs)
+    : groupName(groupName) {
+    for (const auto& config : buttonConfigs) {
+        buttons.push_back({
+            std::get<0>(config),  // name
+            std::get<1>(config),  // widthRatio
+            std::get<2>(config)   // callback
+            });
+    }
+}
+
+// 按钮配色表，按 [是否高亮][是否悬停] 索引
+static const ImVec4 BUTTON_COLORS[2][2] = {
+    { NORMAL_COLOR, HOVER_COLOR },
+    { HIGHLIGHT_COLOR, ImVec4(HIGHLIGHT_COLOR.x * 0.9f, HIGHLIGHT_COLOR.y * 0.9f, HIGHLIGHT_COLOR.z * 0.8f, 1.0f) },
+};
+
+void MyButtonGroup::updateWidthPlan(float totalWidth, float spacing) {
+    if (!planDirty && totalWidth == planTotalWidth && spacing == planSpacing) {
+        return;
+    }
+    planDirty = false;
+    planTotalWidth = totalWidth;
+    planSpacing = spacing;
+
+    int buttonCount = static_cast<int>(buttons.size());
+    if (buttonCount == 0) {
+        return;
+    }
+
+    // 计算总比例
+    float totalRatio = 0.0f;
+    for (const auto& btn : buttons) {
+        totalRatio += btn.widthRatio;
+    }
+
+    // 计算可用宽度（减去间距）
+    float availableWidth = totalWidth - spacing * (buttonCount - 1);
+
+    // 预计算每个按钮的像素宽度（使用整数）
+    float usedWidth = 0.0f;
+    for (int i = 0; i < buttonCount - 1; ++i) {
+        float width = (buttons[i].widthRatio / totalRatio) * availableWidth;
+        width = std::floor(width); // 使用整数像素
+        buttons[i].width = width;
+        usedWidth += width;
+    }
+    // 最后一个按钮使用剩余宽度（确保总宽度准确）
+    buttons[buttonCount - 1].width = availableWidth - usedWidth;
+}
+
+void MyButtonGroup::updateIds(ImGuiID seed) {
+    if (idsValid && seed == idSeed) {
+        return;
+    }
+    idsValid = true;
+    idSeed = seed;
+    groupId = ImHashStr(groupName.c_str(), 0, seed);
+    for (auto& btn : buttons) {
+        btn.id = ImHashStr(btn.name.c_str(), 0, groupId);
+    }
+}
+
+bool MyButtonGroup::buttonWithId(const Button& btn, const ImVec2& size) {
+    ImGuiWindow* window = ImGui::GetCurrentWindow();
+    if (window->SkipItems) {
+        return false;
+    }
+
+    const ImGuiStyle& style = ImGui::GetStyle();
+    const ImVec2 pos = window->DC.CursorPos;
+    const ImVec2 itemSize = ImGui::CalcItemSize(size, btn.labelSize.x + style.FramePadding.x * 2.0f, btn.labelSize.y + style.FramePadding.y * 2.0f);
+    const ImRect bb(pos, ImVec2(pos.x + itemSize.x, pos.y + itemSize.y));
+    ImGui::ItemSize(itemSize, style.FramePadding.y);
+    if (!ImGui::ItemAdd(bb, btn.id)) {
+        return false;
+    }
+
+    bool hovered, held;
+    const bool pressed = ImGui::ButtonBehavior(bb, btn.id, &hovered, &held);
+    const ImU32 col = ImGui::GetColorU32((held && hovered) ? ImGuiCol_ButtonActive : hovered ? ImGuiCol_ButtonHovered : ImGuiCol_Button);
+#if IMGUI_VERSION_NUM >= 19140
+    ImGui::RenderNavCursor(bb, btn.id);     // 1.91.4起改名
+#else
+    ImGui::RenderNavHighlight(bb, btn.id);
+#endif
+    ImGui::RenderFrame(bb.Min, bb.Max, col, true, style.FrameRounding);
+    const ImVec2 textMin(bb.Min.x + style.FramePadding.x, bb.Min.y + style.FramePadding.y);
+    const ImVec2 textMax(bb.Max.x - style.FramePadding.x, bb.Max.y - style.FramePadding.y);
+    ImGui::RenderTextClipped(textMin, textMax, btn.name.c_str(), nullptr, &btn.labelSize, style.ButtonTextAlign, &bb);
+    return pressed;
+}
+
+void MyButtonGroup::render() {
+    PROFILE_SCOPE("MyButtonGroup::render");
+    ALLOC_SCOPE("MyButtonGroup::render");
+    // ID只在所在窗口变化时计算，之后直接压入缓存的组ID
+    updateIds(ImGui::GetCurrentWindow()->IDStack.back());
+    ImGui::PushOverrideID(groupId);
+
+    // 文本尺寸只在字体或字体大小变化时重新计算
+    const ImFont* font = ImGui::GetFont();
+    const float fontSize = ImGui::GetFontSize();
+    if (font != labelFont || fontSize != labelFontSize) {
+        labelFont = font;
+        labelFontSize = fontSize;
+        for (auto& btn : buttons) {
+            btn.labelSize = ImGui::CalcTextSize(btn.name.c_str(), nullptr, true);
+        }
+    }
+
+    // 获取可用宽度（考虑滚动条等）
+    float totalWidth = ImGui::GetContentRegionAvail().x - ImGui::GetStyle().ScrollbarSize;
+    float spacing = ImGui::GetStyle().ItemSpacing.x;
+    int buttonCount = static_cast<int>(buttons.size());
+
+    // 宽度分配只在可用宽度、间距或按钮变化时重新计算
+    updateWidthPlan(totalWidth, spacing);
+
+    // 渲染按钮（颜色与前一个按钮相同时沿用已压栈的颜色）
+    const ImVec4* pushedColor = nullptr;
+    for (int i = 0; i < buttonCount; ++i) {
+        auto& btn = buttons[i];
+        float width = btn.width;
+        ImVec2 buttonSize(width, 40);
+
+        // 获取当前位置
+        ImVec2 cursorPos = ImGui::GetCursorScreenPos();
+        ImVec2 rectMin = cursorPos;
+        ImVec2 rectMax(cursorPos.x + width, cursorPos.y + buttonSize.y);
+
+        // 设置颜色
+        const bool isHighlighted = (i == highlightedIndex);
+        const bool isHovered = ImGui::IsMouseHoveringRect(rectMin, rectMax);
+        const ImVec4* color = &BUTTON_COLORS[isHighlighted][isHovered];
+        if (color != pushedColor) {
+            if (pushedColor) {
+                ImGui::PopStyleColor(3);
+            }
+            ImGui::PushStyleColor(ImGuiCol_Button, *color);
+            ImGui::PushStyleColor(ImGuiCol_ButtonHovered, *color);
+            ImGui::PushStyleColor(ImGuiCol_ButtonActive, *color);
+            pushedColor = color;
+        }
+
+        // 渲染按钮
+        if (buttonWithId(btn, buttonSize)) {
+            // 高亮当前按钮（同时清除其他按钮的高亮）
+            highlightedIndex = i;
+            if (btn.callback) {
+                btn.callback();
+            }
+        }
+
+        // 同一行内渲染（最后一个按钮后不加）
+        if (i < buttonCount - 1) {
+            ImGui::SameLine(0.0f, spacing);
+        }
+    }
+
+    if (pushedColor) {
+        ImGui::PopStyleColor(3);
+    }
+    ImGui::PopID();
+}
+
+void MyButtonGroup::setHighlight(const std::string& buttonName) {
+    setHighlight(findButton(buttonName));
+}
+
+void MyButtonGroup::clickButton(const std::string& buttonName) {
+    clickButton(findButton(buttonName));
+}
+
+ButtonHandle MyButtonGroup::findButton(const std::string& buttonName) const {
+    for (size_t i = 0; i < buttons.size(); ++i) {
+        if (buttons[i].name == buttonName) {
+            return static_cast<ButtonHandle>(i);
+        }
+    }
+    return INVALID_BUTTON;
+}
+
+void MyButtonGroup::setHighlight(ButtonHandle button) {
+    highlightedIndex = (button >= 0 && button < getButtonCount()) ? button : INVALID_BUTTON;
+}
+
+void MyButtonGroup::clickButton(ButtonHandle button) {
+    if (button < 0 || button >= getButtonCount()) {
+        return;
+    }
+    // 高亮当前按钮（同时清除其他按钮的高亮）
+    highlightedIndex = button;
+    auto& btn = buttons[button];
+    if (btn.callback) {
+        btn.callback();
+    }
+}
+
+// MyButtonManager 实现
+struct MyButtonManager::Context {
+    GroupRegistry groups;
+    DeferredState deferred;
+};
+
+namespace {
+thread_local MyButtonManager::Context* t_currentContext = nullptr;
+std::atomic<MyButtonManager::Context*> g_uiContext{ nullptr };
+}
+
+MyButtonManager::Context* MyButtonManager::createContext() {
+    return new Context();
+}
+
+void MyButtonManager::destroyContext(Context* context) {
+    if (t_currentContext == context) {
+        t_currentContext = nullptr;
+    }
+    Context* expected = context;
+    g_uiContext.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+    delete context;
+}
+
+void MyButtonManager::setCurrentContext(Context* context) {
+    t_currentContext = context;
+}
+
+MyButtonManager::Context* MyButtonManager::getCurrentContext() {
+    return t_currentContext;
+}
+
+void MyButtonManager::setUIContext(Context* context) {
+    g_uiContext.store(context, std::memory_order_release);
+}
+
+MyButtonManager::Context* MyButtonManager::getUIContext() {
+    return g_uiContext.load(std::memory_order_acquire);
+}
+
+MyButtonManager::Context& MyButtonManager::getContext() {
+    static Context defaultContext;
+    return t_currentContext ? *t_currentContext : defaultContext;
+}
+
+GroupHandle MyButtonManager::addGroup(MyButtonGroup* group) {
+    auto& registry = getGroups();
+    auto it = registry.byName.find(group->getGroupName());
+    if (it != registry.byName.end()) {
+        registry.groups[it->second] = group;
+        return it->second;
+    }
+    const GroupHandle handle = static_cast<GroupHandle>(registry.groups.size());
+    registry.groups.push_back(group);
+    registry.byName.emplace(group->getGroupName(), handle);
+    return handle;
+}
+
+void MyButtonManager::clickButton(const std::string& groupName, const std::string& buttonName) {
+    if (MyButtonGroup* group = getGroup(findGroup(groupName))) {
+        group->clickButton(buttonName);
+    }
+}
+
+void MyButtonManager::setHighlight(const std::string& groupName, const std::string& buttonName) {
+    if (MyButtonGroup* group = getGroup(findGroup(groupName))) {
+        group->setHighlight(buttonName);
+    }
+}
+
+GroupHandle MyButtonManager::findGroup(const std::string& groupName) {
+    auto& registry = getGroups();
+    auto it = registry.byName.find(groupName);
+    return it != registry.byName.end() ? it->second : INVALID_GROUP;
+}
+
+ButtonHandle MyButtonManager::findButton(GroupHandle group, const std::string& buttonName) {
+    const MyButtonGroup* target = getGroup(group);
+    return target ? target->findButton(buttonName) : INVALID_BUTTON;
+}
+
+void MyButtonManager::clickButton(GroupHandle group, ButtonHandle button) {
+    if (MyButtonGroup* target = getGroup(group)) {
+        target->clickButton(button);
+    }
+}
+
+void MyButtonManager::setHighlight(GroupHandle group, ButtonHandle button) {
+    if (MyButtonGroup* target = getGroup(group)) {
+        target->setHighlight(button);
+    }
+}
+
+MyButtonManager::GroupRegistry& MyButtonManager::getGroups() {
+    return getContext().groups;
+}
+
+MyButtonGroup* MyButtonManager::getGroup(GroupHandle group) {
+    auto& registry = getGroups();
+    if (group < 0 || group >= static_cast<GroupHandle>(registry.groups.size())) {
+        return nullptr;
+    }
+    return registry.groups[group];
+}
+
+// 延迟回调实现
+bool MyButtonManager::deferUIUpdate(DeferredAction action) {
+    return deferUIUpdate(nullptr, std::move(action));
+}
+
+bool MyButtonManager::deferUIUpdate(Context* context, DeferredAction action) {
+    // 后台线程没有当前上下文，投递到主循环处理的界面上下文（否则会进入该线程的默认上下文而无人处理）
+    if (!context) context = t_currentContext ? t_currentContext : getUIContext();
+    auto& state = context ? context->deferred : getDeferredState();
+    if (!state.queue.tryPush(std::move(action))) {
+        state.overflows.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    FrameScheduler::Wake(); // 主循环可能正在空闲等待
+    return true;
+}
+
+void MyButtonManager::processDeferredUpdates() {
+    PROFILE_SCOPE("MyButtonManager::processDeferredUpdates");
+    ALLOC_SCOPE("MyButtonManager::processDeferredUpdates");
+    auto& state = getDeferredState();
+
+    // 只处理本帧开始时已入队的回调，回调中再次入队的留到下一帧
+    const size_t pending = state.queue.sizeApprox();
+    state.highWater = std::max(state.highWater, pending);
+    const size_t batch = state.drainBudget ? std::min(pending, state.drainBudget) : pending;
+
+    state.lastDrained = state.queue.consume([](DeferredAction&& action) {
+        action();
+    }, batch);
+    state.carriedOver = pending - state.lastDrained;
+}
+
+void MyButtonManager::setDeferredDrainBudget(size_t maxPerFrame) {
+    getDeferredState().drainBudget = maxPerFrame;
+}
+
+MyButtonManager::DeferredQueueStats MyButtonManager::getDeferredQueueStats() {
+    auto& state = getDeferredState();
+    return {
+        DEFERRED_QUEUE_CAPACITY,
+        state.queue.sizeApprox(),
+        state.highWater,
+        state.overflows.load(std::memory_order_relaxed),
+        state.lastDrained,
+        state.carriedOver
+    };
+}
+
+MyButtonManager::DeferredState& MyButtonManager::getDeferredState() {
+    return getContext().deferred;
+}
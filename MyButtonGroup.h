@@ -1,53 +1,150 @@
-#pragma once
-
-#include <imgui.h>
-#include <vector>
-#include <string>
-#include <unordered_map>
-#include <functional>
-#include <tuple>
-#include <queue>
-
-
-// ɫ
-constexpr ImVec4 NORMAL_COLOR(1.00f, 1.00f, 1.00f, 1.00f); // ɫ
-constexpr ImVec4 HOVER_COLOR(0.75f, 0.75f, 1.00f, 1.00f);  // ɫ
-constexpr ImVec4 HIGHLIGHT_COLOR(1.00f, 1.00f, 0.60f, 1.00f); // ɫ
-
-class MyButtonGroup {
-public:
-    using ButtonConfig = std::tuple<std::string, float, std::function<void()>>;
-
-    MyButtonGroup(const std::string& groupName, const std::vector<ButtonConfig>& buttonConfigs);
-    void render();
-    void setHighlight(const std::string& buttonName);
-    void clickButton(const std::string& buttonName);
-    const std::string& getGroupName() const { return groupName; }
-
-private:
-    struct Button {
-        std::string name;
-        float widthRatio;
-        std::function<void()> callback;
-        bool isHighlighted = false;
-    };
-
-    std::string groupName;
-    std::vector<Button> buttons;
-};
-
-class MyButtonManager {
-public:
-    static void addGroup(MyButtonGroup* group);
-    static void clickButton(const std::string& groupName, const std::string& buttonName);
-    static void setHighlight(const std::string& groupName, const std::string& buttonName);
-
-    // ӳٻص֧
-    static void deferUIUpdate(const std::function<void()>& action);
-    static void processDeferredUpdates();
-
-private:
-    static std::unordered_map<std::string, MyButtonGroup*>& getGroups();
-    // ӳٻص
-    static std::queue<std::function<void()>>& getDeferredQueue();
+#pragma once
+
+#include <imgui.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <tuple>
+#include <atomic>
+#include "MpscQueue.h"
+#include "InlineFunction.h"
+
+
+// 颜色定义
+constexpr ImVec4 NORMAL_COLOR(1.00f, 1.00f, 1.00f, 1.00f); // 白色
+constexpr ImVec4 HOVER_COLOR(0.75f, 0.75f, 1.00f, 1.00f);  // 淡蓝色
+constexpr ImVec4 HIGHLIGHT_COLOR(1.00f, 1.00f, 0.60f, 1.00f); // 淡黄色
+
+// 按钮组和按钮的句柄：注册后保持不变，按句柄操作是O(1)的数组下标访问
+using GroupHandle = int;
+using ButtonHandle = int;   // 按钮在所属组内的下标
+constexpr GroupHandle INVALID_GROUP = -1;
+constexpr ButtonHandle INVALID_BUTTON = -1;
+
+// 按钮回调：内联存储，不分配堆内存（构造按钮组时需要拷贝配置，因此允许拷贝）
+using ButtonCallback = InlineFunction<void(), 32, true>;
+// 延迟回调：内联存储在延迟队列的槽中，只能移动
+using DeferredAction = InlineFunction<void(), 64>;
+
+class MyButtonGroup {
+public:
+    using ButtonConfig = std::tuple<std::string, float, ButtonCallback>;
+
+    MyButtonGroup(const std::string& groupName, const std::vector<ButtonConfig>& buttonConfigs);
+    void render();
+    void setHighlight(const std::string& buttonName);
+    void clickButton(const std::string& buttonName);
+    const std::string& getGroupName() const { return groupName; }
+
+    // 句柄接口（无效句柄：setHighlight清除高亮，clickButton忽略）
+    ButtonHandle findButton(const std::string& buttonName) const;
+    void setHighlight(ButtonHandle button);
+    void clickButton(ButtonHandle button);
+    ButtonHandle getHighlighted() const { return highlightedIndex; }
+    int getButtonCount() const { return static_cast<int>(buttons.size()); }
+
+private:
+    struct Button {
+        std::string name;       // 显示文本，也用于按名称查找
+        float widthRatio;
+        ButtonCallback callback;
+        float width = 0.0f;     // 缓存的像素宽度（由updateWidthPlan计算）
+        ImGuiID id = 0;         // 缓存的ImGui ID（由updateIds计算）
+        ImVec2 labelSize{};     // 缓存的文本尺寸（字体或字体大小变化时重新计算）
+    };
+
+    // 按可用宽度和间距重新分配按钮宽度，参数与上次相同且按钮未变化时直接返回
+    void updateWidthPlan(float totalWidth, float spacing);
+    // 计算组和按钮的ImGui ID，ID栈顶（所在窗口）与上次相同时直接返回
+    void updateIds(ImGuiID seed);
+    // 与ImGui::Button相同的外观和行为，但使用预先计算的ID和文本尺寸
+    static bool buttonWithId(const Button& btn, const ImVec2& size);
+
+    std::string groupName;
+    std::vector<Button> buttons;
+    ButtonHandle highlightedIndex = INVALID_BUTTON; // 当前高亮的按钮，同一时刻最多一个
+
+    // 宽度分配缓存的输入
+    float planTotalWidth = 0.0f;
+    float planSpacing = 0.0f;
+    bool planDirty = true;      // 按钮集合变化后置位
+
+    // ID缓存：与PushID(组名)和Button(按钮名)得到的ID相同，每帧不再哈希字符串
+    ImGuiID idSeed = 0;         // 计算ID时的ID栈顶
+    ImGuiID groupId = 0;
+    bool idsValid = false;
+    const ImFont* labelFont = nullptr; // 计算文本尺寸时的字体
+    float labelFontSize = 0.0f; // 计算文本尺寸时的字体大小
+};
+
+class MyButtonManager {
+public:
+    // 管理器上下文：按钮组注册表和延迟队列。以下静态接口都作用于调用线程的当前上下文
+    // （未设置时为默认上下文），每个仪表盘实例使用自己的上下文，不同线程可以同时操作不同的上下文
+    struct Context;
+    static Context* createContext();
+    static void destroyContext(Context* context);
+    static void setCurrentContext(Context* context); // nullptr表示默认上下文
+    static Context* getCurrentContext();
+
+    // 进程的界面上下文：由主循环处理其延迟队列的上下文（nullptr表示默认上下文）。
+    // 没有当前上下文的线程（如后台线程）调用不带上下文的deferUIUpdate时投递到这里
+    static void setUIContext(Context* context);
+    static Context* getUIContext();
+
+    // 注册按钮组并返回其句柄；同名组再次注册时替换原组并沿用原句柄
+    static GroupHandle addGroup(MyButtonGroup* group);
+    static void clickButton(const std::string& groupName, const std::string& buttonName);
+    static void setHighlight(const std::string& groupName, const std::string& buttonName);
+
+    // 句柄接口：先用名称解析一次句柄，之后的操作不再哈希字符串或比较名称
+    static GroupHandle findGroup(const std::string& groupName);
+    static ButtonHandle findButton(GroupHandle group, const std::string& buttonName);
+    static void clickButton(GroupHandle group, ButtonHandle button);
+    static void setHighlight(GroupHandle group, ButtonHandle button);
+
+    // 添加延迟回调支持（可在任意线程调用，队列满时返回false并计入溢出次数）
+    // 回调直接构造在队列槽中，入队和处理都不分配堆内存
+    // 不带上下文（或context为nullptr）时投递到调用线程的当前上下文，调用线程没有当前上下文时投递到界面上下文；
+    // 其他线程向某个实例投递时使用带上下文的版本（见DashboardInstance::GetButtonContext）
+    // 上下文销毁前须停止向它投递
+    static bool deferUIUpdate(DeferredAction action);
+    static bool deferUIUpdate(Context* context, DeferredAction action);
+    static void processDeferredUpdates();
+
+    // 每帧最多处理的延迟回调数，0表示不限制（本帧开始时已入队的全部处理）
+    static void setDeferredDrainBudget(size_t maxPerFrame);
+
+    // 延迟队列统计
+    struct DeferredQueueStats {
+        size_t capacity;     // 队列容量
+        size_t pending;      // 当前积压数（近似）
+        size_t highWater;    // 处理前观察到的最大积压数
+        size_t overflows;    // 队列满导致的丢弃次数
+        size_t lastDrained;  // 上一帧处理的回调数
+        size_t carriedOver;  // 上一帧因预算限制留到下一帧的回调数
+    };
+    static DeferredQueueStats getDeferredQueueStats();
+
+private:
+    struct GroupRegistry {
+        std::vector<MyButtonGroup*> groups;                   // 按句柄索引
+        std::unordered_map<std::string, GroupHandle> byName;  // 名称 -> 句柄
+    };
+    static GroupRegistry& getGroups();
+    static MyButtonGroup* getGroup(GroupHandle group);
+
+    // 延迟回调队列（无锁多生产者单消费者）
+    static constexpr size_t DEFERRED_QUEUE_CAPACITY = 4096;
+    using DeferredQueue = MpscQueue<DeferredAction, DEFERRED_QUEUE_CAPACITY>;
+    struct DeferredState {
+        DeferredQueue queue;
+        std::atomic<size_t> overflows{ 0 };
+        size_t drainBudget = 0;
+        size_t highWater = 0;
+        size_t lastDrained = 0;
+        size_t carriedOver = 0;
+    };
+    static DeferredState& getDeferredState();
+    static Context& getContext();
 };
\ No newline at end of file
@@ -0,0 +1,381 @@
+#include "Profiler.h"
+
+#ifdef MYIMGUI_ENABLE_PROFILER
+
+#include <imgui.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_HAS_TSC 1
+#endif
+
+namespace {
+
+constexpr uint64_t RING_CAPACITY = 1 << 14; // 每线程保留的记录数（2的幂）
+constexpr int HISTORY_FRAMES = 120;         // 叠加窗口统计的帧数
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+    uint32_t depth;
+};
+
+// 环形缓冲区的一个槽。导出时其他线程会读到正在被覆盖的槽，用序号检测（每槽一个seqlock）：
+// 写入前把sequence清零，写完后置为记录下标+1；读方前后两次读到的sequence都等于下标+1才算完整。
+// 字段用release写、acquire读代替内存栅栏（TSan不支持栅栏），x86上与普通读写的指令相同
+struct EventSlot {
+    std::atomic<uint64_t> sequence{ 0 }; // 0表示正在写入或从未写入
+    std::atomic<const char*> name{ nullptr };
+    std::atomic<uint64_t> start{ 0 };
+    std::atomic<uint64_t> end{ 0 };
+    std::atomic<uint32_t> depth{ 0 };
+
+    // 读到新写入的字段时，之后读sequence一定能看到写入前的清零
+    ProfileEvent Load() const {
+        return { name.load(std::memory_order_acquire), start.load(std::memory_order_acquire),
+                 end.load(std::memory_order_acquire), depth.load(std::memory_order_acquire) };
+    }
+};
+
+// 每线程环形缓冲区，只有所属线程写入
+struct ThreadBuffer {
+    uint32_t threadIndex = 0;
+    std::atomic<uint64_t> writeIndex{ 0 };
+    uint64_t frameStart = 0; // EndFrame汇总的起点（仅所属线程使用）
+    EventSlot events[RING_CAPACITY];
+};
+
+// 缓冲区只增不删，导出时仍能读到已退出线程留下的记录。
+// 线程退出时把缓冲区放回空闲列表，之后新建的线程优先复用（沿用同一threadIndex，时间上不重叠），
+// 所以缓冲区个数不超过同时使用过分析器的线程数的峰值，不会随线程池的重建无限增长
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::vector<ThreadBuffer*> freeBuffers;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+thread_local uint32_t t_depth = 0;
+thread_local bool t_exited = false;
+
+// 线程退出时归还缓冲区；之后（其他thread_local析构中）的记录直接丢弃
+struct ThreadBufferRelease {
+    ThreadBuffer* buffer = nullptr;
+    ~ThreadBufferRelease() {
+        if (!buffer) return;
+        t_buffer = nullptr;
+        t_exited = true;
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.freeBuffers.push_back(buffer);
+    }
+};
+
+thread_local ThreadBufferRelease t_release;
+
+ThreadBuffer* GetThreadBuffer() {
+    if (!t_buffer && !t_exited) {
+        // 每个线程只在第一次使用时加锁注册
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (!registry.freeBuffers.empty()) {
+            t_buffer = registry.freeBuffers.back();
+            registry.freeBuffers.pop_back();
+            // writeIndex继续递增，旧记录在被覆盖前仍可导出
+            t_buffer->frameStart = t_buffer->writeIndex.load(std::memory_order_relaxed);
+        } else {
+            auto buffer = std::make_unique<ThreadBuffer>();
+            buffer->threadIndex = static_cast<uint32_t>(registry.buffers.size());
+            t_buffer = buffer.get();
+            registry.buffers.push_back(std::move(buffer));
+        }
+        t_release.buffer = t_buffer;
+    }
+    return t_buffer;
+}
+
+inline uint64_t ReadTicks() {
+#ifdef PROFILER_HAS_TSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// 时钟标定：用steady_clock换算计数频率
+struct ClockBase {
+    uint64_t ticks;
+    std::chrono::steady_clock::time_point time;
+};
+
+const ClockBase& GetClockBase() {
+    static const ClockBase base{ ReadTicks(), std::chrono::steady_clock::now() };
+    return base;
+}
+
+double TicksPerMicrosecond() {
+#ifdef PROFILER_HAS_TSC
+    // 标定时间越长越准，超过1秒后固定下来
+    static double cached = 0.0;
+    static bool frozen = false;
+    if (frozen) return cached;
+    const ClockBase& base = GetClockBase();
+    const double elapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - base.time).count();
+    if (elapsedUs < 1000.0) return cached > 0.0 ? cached : 3000.0; // 标定前按3GHz估计
+    cached = static_cast<double>(ReadTicks() - base.ticks) / elapsedUs;
+    frozen = elapsedUs > 1e6;
+    return cached;
+#else
+    return 1000.0;
+#endif
+}
+
+// 叠加窗口用的逐帧统计（只在调用EndFrame的线程使用）
+struct ScopeStats {
+    const char* name = nullptr;
+    uint32_t depth = 0;
+    float history[HISTORY_FRAMES] = {};
+};
+
+struct FrameStats {
+    std::vector<ScopeStats> scopes;
+    float frameMs[HISTORY_FRAMES] = {};
+    int historyPos = 0;
+    int frameCount = 0;
+    uint64_t lastFrameEnd = 0;
+    std::string exportStatus;
+};
+
+FrameStats& GetFrameStats() {
+    static FrameStats stats;
+    return stats;
+}
+
+ScopeStats& FindScope(FrameStats& stats, const char* name, uint32_t depth) {
+    for (ScopeStats& scope : stats.scopes) {
+        if ((scope.name == name || std::strcmp(scope.name, name) == 0) && scope.depth == depth) return scope;
+    }
+    stats.scopes.emplace_back();
+    stats.scopes.back().name = name;
+    stats.scopes.back().depth = depth;
+    return stats.scopes.back();
+}
+
+// 复制所有线程缓冲区中的记录，跳过复制期间正在被覆盖的槽（只会是最旧的几条）
+struct ThreadEvents {
+    uint32_t threadIndex;
+    std::vector<ProfileEvent> events;
+};
+
+std::vector<ThreadEvents> SnapshotEvents() {
+    std::vector<ThreadEvents> result;
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto& buffer : registry.buffers) {
+        const uint64_t end = buffer->writeIndex.load(std::memory_order_acquire);
+        const uint64_t begin = end > RING_CAPACITY ? end - RING_CAPACITY : 0;
+        ThreadEvents thread{ buffer->threadIndex, {} };
+        thread.events.reserve(static_cast<size_t>(end - begin));
+        for (uint64_t i = begin; i < end; i++) {
+            const EventSlot& slot = buffer->events[i & (RING_CAPACITY - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != i + 1) continue; // 正在写入或已被新记录覆盖
+            const ProfileEvent event = slot.Load();
+            if (slot.sequence.load(std::memory_order_relaxed) != i + 1) continue; // 复制期间被覆盖
+            thread.events.push_back(event);
+        }
+        result.push_back(std::move(thread));
+    }
+    return result;
+}
+
+double ToMicroseconds(uint64_t ticks, double ticksPerUs) {
+    const uint64_t base = GetClockBase().ticks;
+    return ticks >= base ? (ticks - base) / ticksPerUs : -((base - ticks) / ticksPerUs);
+}
+
+void WriteJsonString(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* p = text; *p; p++) {
+        if (*p == '"' || *p == '\\') fputc('\\', file);
+        fputc(*p, file);
+    }
+    fputc('"', file);
+}
+
+} // namespace
+
+uint64_t Profiler::Now() {
+    return ReadTicks();
+}
+
+void Profiler::Record(const char* name, uint64_t start, uint64_t end, uint32_t depth) {
+    ThreadBuffer* thread = GetThreadBuffer();
+    if (!thread) return;
+    ThreadBuffer& buffer = *thread;
+    const uint64_t index = buffer.writeIndex.load(std::memory_order_relaxed);
+    EventSlot& slot = buffer.events[index & (RING_CAPACITY - 1)];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_release); // release：字段不会早于清零被读方看到
+    slot.start.store(start, std::memory_order_release);
+    slot.end.store(end, std::memory_order_release);
+    slot.depth.store(depth, std::memory_order_release);
+    slot.sequence.store(index + 1, std::memory_order_release);
+    buffer.writeIndex.store(index + 1, std::memory_order_release);
+}
+
+ProfileScope::ProfileScope(const char* name)
+    : name(name), start(0), depth(t_depth++) {
+    GetClockBase(); // 确保时钟基准早于第一条记录
+    start = ReadTicks();
+}
+
+ProfileScope::~ProfileScope() {
+    const uint64_t end = ReadTicks();
+    t_depth--;
+    Profiler::Record(name, start, end, depth);
+}
+
+void Profiler::EndFrame() {
+    ThreadBuffer* thread = GetThreadBuffer();
+    if (!thread) return;
+    ThreadBuffer& buffer = *thread;
+    FrameStats& stats = GetFrameStats();
+    const double ticksPerMs = TicksPerMicrosecond() * 1000.0;
+
+    // 本帧各作用域耗时清零后累加
+    const int slot = stats.historyPos;
+    for (ScopeStats& scope : stats.scopes) {
+        scope.history[slot] = 0.0f;
+    }
+
+    const uint64_t end = buffer.writeIndex.load(std::memory_order_relaxed);
+    const uint64_t begin = std::max(buffer.frameStart, end > RING_CAPACITY ? end - RING_CAPACITY : 0);
+    for (uint64_t i = begin; i < end; i++) {
+        const ProfileEvent event = buffer.events[i & (RING_CAPACITY - 1)].Load();
+        FindScope(stats, event.name, event.depth).history[slot] += static_cast<float>((event.end - event.start) / ticksPerMs);
+    }
+    buffer.frameStart = end;
+
+    const uint64_t now = ReadTicks();
+    stats.frameMs[slot] = stats.lastFrameEnd ? static_cast<float>((now - stats.lastFrameEnd) / ticksPerMs) : 0.0f;
+    stats.lastFrameEnd = now;
+    stats.historyPos = (stats.historyPos + 1) % HISTORY_FRAMES;
+    stats.frameCount = std::min(stats.frameCount + 1, HISTORY_FRAMES);
+}
+
+void Profiler::DrawOverlay(bool* open) {
+    FrameStats& stats = GetFrameStats();
+    ImGui::SetNextWindowBgAlpha(0.85f);
+    if (!ImGui::Begin("Profiler", open, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings)) {
+        ImGui::End();
+        return;
+    }
+
+    const int count = std::max(stats.frameCount, 1);
+    const int last = (stats.historyPos + HISTORY_FRAMES - 1) % HISTORY_FRAMES;
+    auto summarize = [&](const float* history, float& avg, float& peak) {
+        float sum = 0.0f;
+        peak = 0.0f;
+        for (int i = 0; i < count; i++) {
+            const float value = history[(last - i + HISTORY_FRAMES) % HISTORY_FRAMES];
+            sum += value;
+            peak = std::max(peak, value);
+        }
+        avg = sum / count;
+    };
+
+    float frameAvg, framePeak;
+    summarize(stats.frameMs, frameAvg, framePeak);
+    ImGui::Text("Frame: %.2f ms (avg %.2f, max %.2f, last %d frames)", stats.frameMs[last], frameAvg, framePeak, count);
+    ImGui::PlotLines("##frame", stats.frameMs, HISTORY_FRAMES, stats.historyPos, nullptr, 0.0f, std::max(framePeak, 16.7f), ImVec2(360, 50));
+
+    if (ImGui::BeginTable("##scopes", 4)) {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("Last ms");
+        ImGui::TableSetupColumn("Avg ms");
+        ImGui::TableSetupColumn("Max ms");
+        ImGui::TableHeadersRow();
+        for (const ScopeStats& scope : stats.scopes) {
+            float avg, peak;
+            summarize(scope.history, avg, peak);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%*s%s", static_cast<int>(scope.depth * 2), "", scope.name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", scope.history[last]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", avg);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", peak);
+        }
+        ImGui::EndTable();
+    }
+
+    if (ImGui::Button("Export Chrome trace")) {
+        stats.exportStatus = ExportChromeTrace("profile_trace.json") ? "saved profile_trace.json" : "export failed";
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export CSV")) {
+        stats.exportStatus = ExportCSV("profile.csv") ? "saved profile.csv" : "export failed";
+    }
+    if (!stats.exportStatus.empty()) {
+        ImGui::TextUnformatted(stats.exportStatus.c_str());
+    }
+    ImGui::End();
+}
+
+bool Profiler::ExportChromeTrace(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    const double ticksPerUs = TicksPerMicrosecond();
+    bool first = true;
+    std::fputs("{\"traceEvents\":[\n", file);
+    for (const ThreadEvents& thread : SnapshotEvents()) {
+        for (const ProfileEvent& event : thread.events) {
+            std::fputs(first ? "" : ",\n", file);
+            first = false;
+            std::fputs("{\"name\":", file);
+            WriteJsonString(file, event.name);
+            std::fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                ToMicroseconds(event.start, ticksPerUs), (event.end - event.start) / ticksPerUs, thread.threadIndex);
+        }
+    }
+    std::fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+    return std::fclose(file) == 0;
+}
+
+bool Profiler::ExportCSV(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    const double ticksPerUs = TicksPerMicrosecond();
+    std::fputs("thread,name,depth,start_us,duration_us\n", file);
+    for (const ThreadEvents& thread : SnapshotEvents()) {
+        for (const ProfileEvent& event : thread.events) {
+            std::fprintf(file, "%u,%s,%u,%.3f,%.3f\n", thread.threadIndex, event.name, event.depth,
+                ToMicroseconds(event.start, ticksPerUs), (event.end - event.start) / ticksPerUs);
+        }
+    }
+    return std::fclose(file) == 0;
+}
+
+#endif // MYIMGUI_ENABLE_PROFILER
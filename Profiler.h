@@ -0,0 +1,54 @@
+#pragma once
+
+// 帧内性能分析器
+// 定义 MYIMGUI_ENABLE_PROFILER 后启用；未定义时所有宏展开为空，不产生任何代码。
+//
+//   PROFILE_SCOPE("Name");   // 作用域计时，名称必须是字符串字面量
+//   PROFILE_FRAME_END();     // 每帧结束时在主线程调用一次，汇总本帧数据
+//
+// 每个线程写自己的环形缓冲区（无锁），覆盖最旧的记录。
+// 缓冲区约650KB，线程退出后留给之后新建的线程复用，总数不超过同时使用分析器的线程数的峰值。
+// 叠加窗口显示最近若干帧的各阶段耗时，并可导出Chrome trace JSON或CSV。
+
+#ifdef MYIMGUI_ENABLE_PROFILER
+
+#include <cstdint>
+#include <string>
+
+class Profiler {
+public:
+    static uint64_t Now();                          // 当前时钟计数（x86为TSC，否则为steady_clock纳秒）
+    static void Record(const char* name, uint64_t start, uint64_t end, uint32_t depth);
+
+    static void EndFrame();                         // 汇总本线程本帧的作用域耗时
+    static void DrawOverlay(bool* open = nullptr);  // ImGui叠加窗口
+
+    // 导出所有线程缓冲区中的记录，成功返回true
+    static bool ExportChromeTrace(const std::string& path);
+    static bool ExportCSV(const std::string& path);
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name);
+    ~ProfileScope();
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+    uint32_t depth;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_FRAME_END() Profiler::EndFrame()
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FRAME_END() ((void)0)
+
+#endif
@@ -0,0 +1,246 @@
+#include "RegionGeometryCache.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+bool RegionDrawKey::operator==(const RegionDrawKey& other) const {
+    return pos.x == other.pos.x && pos.y == other.pos.y &&
+        size.x == other.size.x && size.y == other.size.y &&
+        color == other.color &&
+        clipRect.x == other.clipRect.x && clipRect.y == other.clipRect.y &&
+        clipRect.z == other.clipRect.z && clipRect.w == other.clipRect.w &&
+        fontSize == other.fontSize &&
+        textureId == other.textureId &&
+        drawListFlags == other.drawListFlags;
+}
+
+RegionGeometryCache::RegionGeometryCache()
+    : workers(1) {
+}
+
+RegionGeometryCache::~RegionGeometryCache() = default;
+
+void RegionGeometryCache::Reset(size_t regionCount) {
+    entries.clear();
+    entries.resize(regionCount);
+}
+
+void RegionGeometryCache::SetWorkerCount(int count) {
+    workers.resize(std::max(1, count));
+}
+
+void RegionGeometryCache::SetDrawListSharedData(ImDrawListSharedData* data) {
+    if (data == sharedData) return;
+    sharedData = data;
+    for (Worker& state : workers) {
+        if (state.scratch) state.scratch->_Data = data;
+    }
+}
+
+void RegionGeometryCache::Invalidate(RegionHandle region) {
+    if (region >= 0 && static_cast<size_t>(region) < entries.size()) {
+        entries[region].valid = false;
+        entries[region].label.label = std::string_view(); // 同一缓冲区中的标签可能已改写，不能按指针沿用测量结果
+    }
+}
+
+void RegionLabelFonts::AddToAtlas(ImFontAtlas* atlas, float pixelScale) {
+    if (atlas->Fonts.empty()) {
+        atlas->AddFontDefault();
+    }
+    for (int i = 0; i < SIZE_COUNT; i++) {
+        ImFontConfig config;
+        config.SizePixels = static_cast<float>(static_cast<int>(SIZES[i] * pixelScale + 0.5f));
+        fonts[i] = atlas->AddFontDefault(&config);
+    }
+}
+
+const ImFont* RegionLabelFonts::Select(float size) const {
+    if (!fonts[0]) return nullptr;
+    int selected = 0;
+    for (int i = 1; i < SIZE_COUNT && fonts[i]->FontSize <= size; i++) {
+        selected = i;
+    }
+    return fonts[selected];
+}
+
+// 与ImGui::CalcTextSize一致：宽度向上取整
+static ImVec2 MeasureText(const ImFont* font, float size, std::string_view text) {
+    ImVec2 textSize = font->CalcTextSizeA(size, FLT_MAX, 0.0f, text.data(), text.data() + text.size());
+    textSize.x = static_cast<float>(static_cast<int>(textSize.x + 0.99999f));
+    return textSize;
+}
+
+int RegionGeometryCache::FitLabel(RegionLabelFit& fit, const RegionDrawKey& key, std::string_view label,
+    const ImFont* font, const RegionLabelFonts* labelFonts) {
+    if (label.empty() || !font) {
+        fit.font = nullptr;
+        fit.rectSize = ImVec2(-1.0f, -1.0f);
+        return 0;
+    }
+
+    // 标签、字体或字号变化时重新测量
+    int measured = 0;
+    if (fit.label.data() != label.data() || fit.label.size() != label.size() ||
+        fit.baseFont != font || fit.fontSize != key.fontSize) {
+        fit.label = label;
+        fit.baseFont = font;
+        fit.fontSize = key.fontSize;
+        fit.textSize = MeasureText(font, key.fontSize, label);
+        fit.rectSize = ImVec2(-1.0f, -1.0f);
+        fit.sizedFont = nullptr;
+        measured++;
+    }
+    if (fit.rectSize.x == key.size.x && fit.rectSize.y == key.size.y) return measured;
+    fit.rectSize = key.size;
+
+    const float scale = std::min(1.0f,
+        std::min((key.size.x - 10.0f) / fit.textSize.x,
+            (key.size.y - 10.0f) / fit.textSize.y));
+    if (scale <= 0.0f) { // 区域太小放不下文字
+        fit.font = nullptr;
+        return measured;
+    }
+    if (scale >= 1.0f || !labelFonts || labelFonts->IsEmpty()) {
+        fit.font = font;
+        fit.drawSize = key.fontSize * scale;
+        fit.drawWidth = fit.textSize.x * scale;
+        return measured;
+    }
+
+    // 需要缩小：选用烘焙的字号，只有换档时才测量该字体下的宽度
+    const float target = key.fontSize * scale;
+    const ImFont* sized = labelFonts->Select(target);
+    if (sized != fit.sizedFont) {
+        fit.sizedFont = sized;
+        fit.sizedWidth = MeasureText(sized, sized->FontSize, label).x;
+        measured++;
+    }
+    fit.font = sized;
+    fit.drawSize = std::min(sized->FontSize, target); // 比最小一档还小时才缩放字形
+    fit.drawWidth = fit.sizedWidth * (fit.drawSize / sized->FontSize);
+    return measured;
+}
+
+void RegionGeometryCache::TessellateFit(ImDrawList* drawList, const RegionDrawKey& key, std::string_view label,
+    const RegionLabelFit& fit) {
+    const ImVec2 pos = key.pos;
+    const ImVec2 size = key.size;
+
+    // 绘制区域背景
+    drawList->AddRectFilled(pos,
+        { pos.x + size.x, pos.y + size.y },
+        key.color);
+
+    // 绘制边框
+    drawList->AddRect(pos,
+        { pos.x + size.x, pos.y + size.y },
+        ImColor(0.7f, 0.7f, 0.7f, 1.0f),
+        0.0f, 0, 1.5f);
+
+    // 绘制区域名称
+    if (!fit.font) return;
+
+    ImVec2 textPos(
+        pos.x + (size.x - fit.drawWidth) * 0.5f,
+        pos.y + (size.y - fit.drawSize) * 0.5f
+    );
+
+    // 绘制文本
+    drawList->AddText(fit.font, fit.drawSize, textPos, ImColor(0.1f, 0.1f, 0.1f, 1.0f),
+        label.data(), label.data() + label.size());
+}
+
+void RegionGeometryCache::Tessellate(ImDrawList* drawList, const RegionDrawKey& key, std::string_view label, const ImFont* font) {
+    RegionLabelFit fit;
+    FitLabel(fit, key, label, font, nullptr);
+    TessellateFit(drawList, key, label, fit);
+}
+
+bool RegionGeometryCache::Update(RegionHandle region, const RegionDrawKey& key, std::string_view label, const ImFont* font, int worker) {
+    Entry& entry = entries[region];
+    if (entry.valid && entry.key == key) return false;
+
+    Worker& state = workers[worker];
+    if (!state.scratch) {
+        state.scratch = std::make_unique<ImDrawList>(sharedData);
+    }
+
+    // 在临时列表中细分，状态与窗口绘制列表保持一致（结果与使用哪个列表无关）
+    ImDrawList* list = state.scratch.get();
+    list->_ResetForNewFrame();
+    list->Flags = key.drawListFlags;
+    list->PushClipRect(ImVec2(key.clipRect.x, key.clipRect.y), ImVec2(key.clipRect.z, key.clipRect.w));
+    list->PushTextureID(key.textureId);
+    state.measured += FitLabel(entry.label, key, label, font, &labelFonts);
+    TessellateFit(list, key, label, entry.label);
+
+    entry.vertices.assign(list->VtxBuffer.Data, list->VtxBuffer.Data + list->VtxBuffer.Size);
+    entry.indices.assign(list->IdxBuffer.Data, list->IdxBuffer.Data + list->IdxBuffer.Size);
+    entry.key = key;
+    entry.valid = true;
+    state.retessellated++;
+    return true;
+}
+
+int RegionGeometryCache::GetRetessellatedCount() const {
+    int count = 0;
+    for (const Worker& state : workers) {
+        count += state.retessellated;
+    }
+    return count;
+}
+
+int RegionGeometryCache::GetMeasuredCount() const {
+    int count = 0;
+    for (const Worker& state : workers) {
+        count += state.measured;
+    }
+    return count;
+}
+
+void RegionGeometryCache::ResetFrameStats() {
+    for (Worker& state : workers) {
+        state.retessellated = 0;
+        state.measured = 0;
+    }
+}
+
+void RegionGeometryCache::Append(ImDrawList* drawList, const std::vector<RegionHandle>& regions) const {
+    // 16位索引时每批顶点数不能超过索引范围
+    const size_t maxBatchVertices = sizeof(ImDrawIdx) == 2 ? 60000 : 0x7FFFFFFF;
+
+    size_t begin = 0;
+    while (begin < regions.size()) {
+        // 统计这一批的顶点/索引数
+        size_t end = begin;
+        size_t vtxCount = 0;
+        size_t idxCount = 0;
+        while (end < regions.size()) {
+            const Entry& entry = entries[regions[end]];
+            if (end > begin && vtxCount + entry.vertices.size() > maxBatchVertices) break;
+            vtxCount += entry.vertices.size();
+            idxCount += entry.indices.size();
+            end++;
+        }
+
+        // 一次预留，整批拷贝
+        drawList->PrimReserve(static_cast<int>(idxCount), static_cast<int>(vtxCount));
+        for (size_t i = begin; i < end; i++) {
+            const Entry& entry = entries[regions[i]];
+            const unsigned int base = drawList->_VtxCurrentIdx;
+            const size_t vertexCount = entry.vertices.size();
+            if (vertexCount > 0) {
+                memcpy(drawList->_VtxWritePtr, entry.vertices.data(), vertexCount * sizeof(ImDrawVert));
+            }
+            ImDrawIdx* idx = drawList->_IdxWritePtr;
+            for (ImDrawIdx index : entry.indices) {
+                *idx++ = static_cast<ImDrawIdx>(base + index);
+            }
+            drawList->_VtxWritePtr += vertexCount;
+            drawList->_IdxWritePtr = idx;
+            drawList->_VtxCurrentIdx += static_cast<unsigned int>(vertexCount);
+        }
+        begin = end;
+    }
+}
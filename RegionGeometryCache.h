@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string_view>
+#include "RegionTree.h"
+
+// 区域绘制参数，同时作为几何缓存的键
+struct RegionDrawKey {
+    ImVec2 pos;             // 位置
+    ImVec2 size;            // 大小
+    ImU32 color = 0;        // 背景色（由悬停/焦点状态决定）
+    ImVec4 clipRect;        // 裁剪矩形（文字按裁剪矩形剔除字形）
+    float fontSize = 0.0f;  // 字号
+    ImTextureID textureId = ImTextureID(); // 字体纹理
+    int drawListFlags = 0;  // 抗锯齿等绘制标志
+
+    bool operator==(const RegionDrawKey& other) const;
+    bool operator!=(const RegionDrawKey& other) const { return !(*this == other); }
+};
+
+// 区域标签字体：默认字体按一组离散字号烘焙进字体图集。
+// 标签放不下需要缩小时选用不大于目标字号的最大一档，按烘焙字号绘制，字形不经缩放（不发虚）
+class RegionLabelFonts {
+public:
+    static constexpr int SIZE_COUNT = 7;
+    static constexpr float SIZES[SIZE_COUNT] = { 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f }; // 缩放前的像素字号
+
+    // 须在字体图集构建（渲染后端创建字体纹理）之前调用，pixelScale为DPI缩放
+    // 图集为空时先添加默认字体，保证Fonts[0]仍是界面字体
+    void AddToAtlas(ImFontAtlas* atlas, float pixelScale);
+    bool IsEmpty() const { return fonts[0] == nullptr; }
+
+    // 不大于size的最大一档，都大于size时返回最小一档，未添加时返回nullptr
+    const ImFont* Select(float size) const;
+
+private:
+    const ImFont* fonts[SIZE_COUNT] = {};
+};
+
+// 标签适配结果：按(标签, 字体, 字号)缓存测量的尺寸，按区域尺寸缓存缩放和选用的字体，
+// 只有标签或布局变化时才重新计算；颜色等其他键变化时直接沿用
+struct RegionLabelFit {
+    std::string_view label;             // 测量的标签（字符串池中的视图，比较指针和长度）
+    const ImFont* baseFont = nullptr;   // 测量用的字体
+    float fontSize = 0.0f;              // 测量用的字号
+    ImVec2 textSize{ 0.0f, 0.0f };      // 标签在该字号下的尺寸（宽度向上取整）
+    ImVec2 rectSize{ -1.0f, -1.0f };    // 计算缩放时的区域尺寸
+    const ImFont* font = nullptr;       // 绘制用的字体，nullptr表示不绘制
+    float drawSize = 0.0f;              // 绘制字号
+    float drawWidth = 0.0f;             // 绘制字号下的文字宽度
+    const ImFont* sizedFont = nullptr;  // 最近测量的烘焙字体
+    float sizedWidth = 0.0f;            // 该字体在其烘焙字号下的文字宽度
+};
+
+// 区域几何缓存：保存每个区域细分好的顶点/索引，
+// 键不变时直接批量拷贝到窗口的ImDrawList，只有变化的区域重新细分
+// 不同区域的Update可以由不同工作线程并行调用，每个工作线程使用自己的临时绘制列表
+class RegionGeometryCache {
+public:
+    RegionGeometryCache();
+    ~RegionGeometryCache();
+
+    void Reset(size_t regionCount);          // 区域树替换时调用
+    void SetWorkerCount(int count);          // 并行细分的工作线程数，worker参数须小于该值
+    // 临时绘制列表使用的共享数据，每帧在调用线程上设置（工作线程没有当前ImGui上下文）
+    void SetDrawListSharedData(ImDrawListSharedData* data);
+    void Invalidate(RegionHandle region);    // 强制区域下次重新细分并重新测量标签（标签内容可能已变化）
+
+    // 确保区域几何与key一致，返回是否重新细分
+    bool Update(RegionHandle region, const RegionDrawKey& key, std::string_view label, const ImFont* font, int worker = 0);
+
+    // 按顺序把区域几何追加到drawList
+    void Append(ImDrawList* drawList, const std::vector<RegionHandle>& regions) const;
+
+    // 直接细分到drawList（不经过缓存，也不使用烘焙的标签字体）
+    static void Tessellate(ImDrawList* drawList, const RegionDrawKey& key, std::string_view label, const ImFont* font);
+
+    // 烘焙标签字体，须在字体图集构建之前调用
+    void AddLabelFonts(ImFontAtlas* atlas, float pixelScale) { labelFonts.AddToAtlas(atlas, pixelScale); }
+
+    int GetRetessellatedCount() const;        // 本帧重新细分的区域数
+    int GetMeasuredCount() const;             // 本帧测量文字尺寸的次数
+    void ResetFrameStats();
+
+private:
+    struct Entry {
+        RegionDrawKey key;
+        bool valid = false;
+        RegionLabelFit label;
+        std::vector<ImDrawVert> vertices;
+        std::vector<ImDrawIdx> indices; // 相对本区域第一个顶点
+    };
+
+    // 每个工作线程的细分状态，按缓存行对齐避免伪共享
+    struct alignas(64) Worker {
+        std::unique_ptr<ImDrawList> scratch; // 细分用的临时绘制列表
+        int retessellated = 0;
+        int measured = 0;
+    };
+
+    // 更新标签适配，返回测量文字的次数
+    static int FitLabel(RegionLabelFit& fit, const RegionDrawKey& key, std::string_view label,
+        const ImFont* font, const RegionLabelFonts* labelFonts);
+    static void TessellateFit(ImDrawList* drawList, const RegionDrawKey& key, std::string_view label,
+        const RegionLabelFit& fit);
+
+    std::vector<Entry> entries;
+    RegionLabelFonts labelFonts;
+    ImDrawListSharedData* sharedData = nullptr;
+    std::vector<Worker> workers;
+};
@@ -0,0 +1,136 @@
+#include "RegionLiveData.h"
+#include "FrameScheduler.h"
+#include <algorithm>
+#include <cstring>
+
+RegionLiveData::RegionLiveData(int capacity)
+    : capacity(std::max(capacity, 0)) {
+    const size_t size = static_cast<size_t>(this->capacity);
+    for (int b = 0; b < 3; b++) {
+        buffers[b].values.resize(size);
+        buffers[b].changed.reserve(size);
+        pending[b].reserve(size);
+        pendingMark[b].assign(size, 0);
+    }
+    current.resize(size);
+    channelIds.resize(size);
+    unconfirmed.reserve(size);
+    unconfirmedMark.assign(size, 0);
+    changedSequence.assign(size, 0);
+}
+
+int RegionLiveData::RegisterChannel(std::string_view regionId) {
+    const std::string id(regionId);
+    auto it = channelIndex.find(id);
+    if (it != channelIndex.end()) return it->second;
+    if (channelCount >= capacity) return -1;
+
+    // ID在发布前写好，界面线程通过快照的channelCount看到新通道时ID已经可读
+    const int channel = channelCount++;
+    channelIds[channel] = id;
+    channelIndex.emplace(id, channel);
+    BeginWrite(channel);
+    return channel;
+}
+
+RegionLiveValue* RegionLiveData::BeginWrite(int channel) {
+    if (channel < 0 || channel >= channelCount) return nullptr;
+    for (int b = 0; b < 3; b++) {
+        if (!pendingMark[b][channel]) {
+            pendingMark[b][channel] = 1;
+            pending[b].push_back(channel);
+        }
+    }
+    if (!unconfirmedMark[channel]) {
+        unconfirmedMark[channel] = 1;
+        unconfirmed.push_back(channel);
+    }
+    changedSequence[channel] = sequence + 1;
+    hasUpdates = true;
+    updateCount.store(updateCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return &current[channel];
+}
+
+void RegionLiveData::SetNumber(int channel, double number) {
+    if (RegionLiveValue* value = BeginWrite(channel)) {
+        value->number = number;
+        value->flags |= RegionLiveValue::HAS_NUMBER;
+    }
+}
+
+void RegionLiveData::SetText(int channel, std::string_view text) {
+    if (RegionLiveValue* value = BeginWrite(channel)) {
+        const size_t length = std::min(text.size(), static_cast<size_t>(RegionLiveValue::TEXT_CAPACITY));
+        std::memcpy(value->text, text.data(), length);
+        value->text[length] = '\0';
+        value->textLength = static_cast<unsigned char>(length);
+        value->flags |= RegionLiveValue::HAS_TEXT;
+    }
+}
+
+void RegionLiveData::SetStatusColor(int channel, ImU32 color) {
+    if (RegionLiveValue* value = BeginWrite(channel)) {
+        value->statusColor = color;
+        if (color) value->flags |= RegionLiveValue::HAS_COLOR;
+        else value->flags &= ~RegionLiveValue::HAS_COLOR;
+    }
+}
+
+void RegionLiveData::SetValue(int channel, const RegionLiveValue& newValue) {
+    if (RegionLiveValue* value = BeginWrite(channel)) {
+        *value = newValue;
+    }
+}
+
+void RegionLiveData::Clear(int channel) {
+    if (RegionLiveValue* value = BeginWrite(channel)) {
+        *value = RegionLiveValue();
+    }
+}
+
+void RegionLiveData::Publish() {
+    if (!hasUpdates) return;
+    hasUpdates = false;
+
+    // 后台缓冲区补上它之后的所有修改
+    RegionLiveSnapshot& snapshot = buffers[back];
+    for (int channel : pending[back]) {
+        snapshot.values[channel] = current[channel];
+        pendingMark[back][channel] = 0;
+    }
+    pending[back].clear();
+
+    // 变化列表：界面已取得的快照之后变化过的通道（读到的序号可能偏旧，多列出的通道只会多刷新一次）
+    sequence++;
+    const unsigned long long acquired = acquiredSequence.load(std::memory_order_acquire);
+    size_t kept = 0;
+    for (int channel : unconfirmed) {
+        if (changedSequence[channel] > acquired) unconfirmed[kept++] = channel;
+        else unconfirmedMark[channel] = 0;
+    }
+    unconfirmed.resize(kept);
+
+    // 界面长时间没有取快照时列表会接近全部通道，超过四分之一后改为全部刷新，发布的开销不随积压增长
+    if (unconfirmed.size() > static_cast<size_t>(capacity / 4) && unconfirmed.size() > 64) {
+        for (int channel : unconfirmed) unconfirmedMark[channel] = 0;
+        unconfirmed.clear();
+        overflowSequence = sequence;
+    }
+    snapshot.sequence = sequence;
+    snapshot.channelCount = channelCount;
+    snapshot.fullRefresh = overflowSequence > acquired;
+    snapshot.changed.assign(unconfirmed.begin(), unconfirmed.end());
+
+    // 与中间缓冲区交换，换回的缓冲区（界面放下的旧前台或界面跳过的快照）成为新的后台
+    back = static_cast<int>(middle.exchange(static_cast<unsigned int>(back) | DIRTY, std::memory_order_acq_rel) & INDEX_MASK);
+    publishCount.store(sequence, std::memory_order_relaxed);
+    FrameScheduler::Wake();
+}
+
+bool RegionLiveData::Acquire() {
+    if (!(middle.load(std::memory_order_relaxed) & DIRTY)) return false;
+    front = static_cast<int>(middle.exchange(static_cast<unsigned int>(front), std::memory_order_acq_rel) & INDEX_MASK);
+    acquiredSequence.store(buffers[front].sequence, std::memory_order_release);
+    acquireCount.store(acquireCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return true;
+}
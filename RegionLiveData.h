@@ -0,0 +1,103 @@
+#pragma once
+
+#include <imgui.h>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 区域的实时值：数值、状态色和短字符串可以任意组合
+struct RegionLiveValue {
+    static constexpr int TEXT_CAPACITY = 31;
+    enum : unsigned char { HAS_NUMBER = 1, HAS_TEXT = 2, HAS_COLOR = 4 };
+
+    double number = 0.0;
+    ImU32 statusColor = 0;        // 状态色，替换默认背景色（悬停/焦点色仍然优先）
+    unsigned char flags = 0;
+    unsigned char textLength = 0;
+    char text[TEXT_CAPACITY + 1] = {};
+
+    std::string_view GetText() const { return std::string_view(text, textLength); }
+};
+
+// 一次发布的快照
+struct RegionLiveSnapshot {
+    unsigned long long sequence = 0;     // 发布序号，0表示尚未发布
+    int channelCount = 0;                // 已注册的通道数
+    bool fullRefresh = false;            // 变化的通道太多，没有逐个列出：所有通道都视为有变化
+    std::vector<RegionLiveValue> values; // 按通道
+    std::vector<int> changed;            // 相对界面上一个快照有新值的通道（不重复）
+};
+
+// 区域实时数据源：三缓冲快照，一个生产者线程写入并发布，界面线程每帧换入最新的完整快照。
+// 双方都不加锁、不等待：生产者只写后台缓冲区，发布时与中间缓冲区交换；
+// 界面线程在有新发布时把前台缓冲区与中间缓冲区交换，前台缓冲区在下次换入之前保持不变（不会读到写了一半的值）。
+// 界面跳过的快照不会丢失变化：changed总是相对界面实际取得的上一个快照计算。
+// 同一实例只能有一个生产者线程，多个数据源各用一个实例（RegionManager::AddLiveData）。
+// 每次发布调用FrameScheduler::Wake()，空闲等待中的主循环立即醒来换入新快照。
+//
+//   int channel = data.RegisterChannel("Row0##1");  // 生产者线程，按区域ID注册通道
+//   data.SetNumber(channel, 42.0); data.Publish();
+class RegionLiveData {
+public:
+    explicit RegionLiveData(int capacity); // 通道容量，缓冲区在构造时一次分配
+    RegionLiveData(const RegionLiveData&) = delete;
+    RegionLiveData& operator=(const RegionLiveData&) = delete;
+
+    // 生产者线程
+    int RegisterChannel(std::string_view regionId); // 同一ID返回同一通道，容量已满返回-1
+    void SetNumber(int channel, double value);
+    void SetText(int channel, std::string_view text); // 超出TEXT_CAPACITY的部分截断
+    void SetStatusColor(int channel, ImU32 color);    // 0表示恢复默认背景色
+    void SetValue(int channel, const RegionLiveValue& value);
+    void Clear(int channel);
+    void Publish(); // 发布自上次发布以来的修改，没有修改时不发布
+
+    // 界面线程
+    bool Acquire(); // 换入最新发布的快照，有新快照时返回true
+    bool HasNewSnapshot() const { return (middle.load(std::memory_order_relaxed) & DIRTY) != 0; } // 有尚未换入的发布
+    const RegionLiveSnapshot& GetSnapshot() const { return buffers[front]; }
+    const std::string& GetChannelId(int channel) const { return channelIds[channel]; } // channel须小于快照的channelCount
+
+    int GetCapacity() const { return capacity; }
+
+    // 统计（任意线程读取，近似值）
+    unsigned long long GetUpdateCount() const { return updateCount.load(std::memory_order_relaxed); }
+    unsigned long long GetPublishCount() const { return publishCount.load(std::memory_order_relaxed); }
+    unsigned long long GetAcquireCount() const { return acquireCount.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr unsigned int INDEX_MASK = 3;
+    static constexpr unsigned int DIRTY = 4; // 中间缓冲区是界面尚未取得的新快照
+
+    RegionLiveValue* BeginWrite(int channel); // 标记通道有变化，返回可写的值，通道无效时返回nullptr
+
+    const int capacity;
+    RegionLiveSnapshot buffers[3];
+
+    // 生产者状态
+    int back = 2;
+    int channelCount = 0;
+    bool hasUpdates = false;
+    std::vector<RegionLiveValue> current;           // 最新的值
+    std::vector<std::string> channelIds;            // 注册后不再修改，界面线程按快照的channelCount读取
+    std::unordered_map<std::string, int> channelIndex;
+    std::vector<int> pending[3];                    // 各缓冲区落后于current的通道
+    std::vector<unsigned char> pendingMark[3];
+    std::vector<int> unconfirmed;                   // 界面可能还没有看到新值的通道
+    std::vector<unsigned char> unconfirmedMark;
+    std::vector<unsigned long long> changedSequence; // 各通道最后一次变化所在的发布序号
+    unsigned long long sequence = 0;                 // 最近一次发布的序号
+    unsigned long long overflowSequence = 0;         // 最近一次变化列表溢出（改为全部刷新）的发布序号
+
+    // 界面线程状态
+    int front = 0;
+
+    // 共享状态，按缓存行隔开
+    alignas(64) std::atomic<unsigned int> middle{ 1 };
+    alignas(64) std::atomic<unsigned long long> acquiredSequence{ 0 }; // 界面取得的最新快照序号
+    alignas(64) std::atomic<unsigned long long> updateCount{ 0 };
+    std::atomic<unsigned long long> publishCount{ 0 };
+    alignas(64) std::atomic<unsigned long long> acquireCount{ 0 };
+};
@@ -1,273 +1,565 @@
-#include "RegionManager.h"
-#include <iostream>
-
-bool Region::IsLeaf() const {
-    return type == REGION_LEAF;
-}
-
-Region* Region::FindRegion(const std::string& targetId) {
-    if (id == targetId) return this;
-    for (auto& child : children) {
-        if (Region* found = child.FindRegion(targetId)) {
-            return found;
-        }
-    }
-    return nullptr;
-}
-
-std::string IDGenerator::GetID(const std::string& prefix) {
-    return prefix + "##" + std::to_string(counter++);
-}
-
-Region RegionManager::CreateRegion(Region& parent, RegionType type,
-    const std::string& name, const std::string& groupId) {
-    Region newRegion;
-    newRegion.id = idGen.GetID(name);
-    newRegion.name = name;
-    newRegion.type = type;
-    newRegion.parent = &parent;
-    newRegion.groupId = groupId;
-    return newRegion;
-}
-
-void RegionManager::CreateLayout() {
-    // 
-    root.id = "root";
-    root.name = "Root";
-    root.type = REGION_ROOT;
-    root.parent = nullptr;
-
-    // һ
-    Region row1 = CreateRegion(root, REGION_ROW, "Row1");
-    root.children.push_back(row1);
-
-    // һеҶ
-    Region& row1Ref = root.children[0];
-    row1Ref.children.push_back(CreateRegion(row1Ref, REGION_LEAF, "A1"));
-    row1Ref.children.push_back(CreateRegion(row1Ref, REGION_LEAF, "A2"));
-
-    // ڶ
-    Region row2 = CreateRegion(root, REGION_ROW, "Row2");
-    root.children.push_back(row2);
-
-    // A1
-    Region groupA1 = CreateRegion(row2, REGION_GROUP, "A1 Group", "A1");
-    Region& row2Ref = root.children[1];
-    row2Ref.children.push_back(groupA1);
-
-    // A1Ҷ
-    Region& groupA1Ref = row2Ref.children[0];
-    groupA1Ref.children.push_back(CreateRegion(groupA1Ref, REGION_LEAF, "A1B1", "A1"));
-    groupA1Ref.children.push_back(CreateRegion(groupA1Ref, REGION_LEAF, "A1B2", "A1"));
-
-    // A2
-    Region groupA2 = CreateRegion(row2Ref, REGION_GROUP, "A2 Group", "A2");
-    row2Ref.children.push_back(groupA2);
-
-    // A2Ҷ
-    Region& groupA2Ref = row2Ref.children[1];
-    groupA2Ref.children.push_back(CreateRegion(groupA2Ref, REGION_LEAF, "A2B1", "A2"));
-    groupA2Ref.children.push_back(CreateRegion(groupA2Ref, REGION_LEAF, "A2B2", "A2"));
-    groupA2Ref.children.push_back(CreateRegion(groupA2Ref, REGION_LEAF, "A2B3", "A2"));
-}
-
-void RegionManager::UpdateLayout(Region& region, const ImVec2& pos, const ImVec2& size) {
-    region.pos = pos;
-    region.size = size;
-
-    if (region.children.empty()) return;
-
-    // ;ַʽ
-    if (region.type == REGION_ROW) {
-        // в֣ˮƽָ
-        const float childWidth = size.x / region.children.size();
-        for (size_t i = 0; i < region.children.size(); i++) {
-            Region& child = region.children[i];
-            UpdateLayout(child,
-                { pos.x + i * childWidth, pos.y },
-                { childWidth, size.y });
-        }
-    }
-    else if (region.type == REGION_GROUP) {
-        // 鲼֣ˮƽָ
-        const float childWidth = size.x / region.children.size();
-        for (size_t i = 0; i < region.children.size(); i++) {
-            Region& child = region.children[i];
-            UpdateLayout(child,
-                { pos.x + i * childWidth, pos.y },
-                { childWidth, size.y });
-        }
-    }
-    else if (region.type == REGION_ROOT) {
-        // ֱָ֣
-        const float rowHeight = size.y / region.children.size();
-        for (size_t i = 0; i < region.children.size(); i++) {
-            Region& child = region.children[i];
-            UpdateLayout(child,
-                { pos.x, pos.y + i * rowHeight },
-                { size.x, rowHeight });
-        }
-    }
-}
-
-void RegionManager::DrawRegion(Region& region) {
-    // 
-    if (region.type == REGION_ROOT) {
-        for (auto& child : region.children) {
-            DrawRegion(child);
-        }
-        return;
-    }
-
-    // ȷIDΨһ
-    ImGui::PushID(region.id.c_str());
-
-    // ɫ
-    ImColor color;
-    if (region.state.isFocused) {
-        color = ImColor(1.0f, 0.7f, 0.4f, 1.0f); // ɫ: ɫ
-    }
-    else if (region.state.isHovered) {
-        color = ImColor(0.95f, 0.95f, 0.95f, 1.0f); // ͣɫ: ǳɫ
-    }
-    else {
-        color = ImColor(0.92f, 0.92f, 0.92f, 1.0f); // Ĭɫ: ӽɫĻɫ
-    }
-
-    // 򱳾
-    ImDrawList* drawList = ImGui::GetWindowDrawList();
-    drawList->AddRectFilled(region.pos,
-        { region.pos.x + region.size.x, region.pos.y + region.size.y },
-        color);
-
-    // Ʊ߿
-    drawList->AddRect(region.pos,
-        { region.pos.x + region.size.x, region.pos.y + region.size.y },
-        ImColor(0.7f, 0.7f, 0.7f, 1.0f),
-        0.0f, 0, 1.5f);
-
-    // 
-    if (!region.name.empty()) {
-        ImVec2 textSize = ImGui::CalcTextSize(region.name.c_str());
-        float scale = std::min(1.0f,
-            std::min((region.size.x - 10.0f) / textSize.x,
-                (region.size.y - 10.0f) / textSize.y));
-
-        ImVec2 textPos(
-            region.pos.x + (region.size.x - textSize.x * scale) * 0.5f,
-            region.pos.y + (region.size.y - ImGui::GetTextLineHeight() * scale) * 0.5f
-        );
-
-        // ı
-        ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[0]);
-        ImGui::SetWindowFontScale(scale);
-        drawList->AddText(textPos, ImColor(0.1f, 0.1f, 0.1f, 1.0f), region.name.c_str());
-        ImGui::SetWindowFontScale(1.0f);
-        ImGui::PopFont();
-    }
-
-    if (region.IsLeaf()) {
-        // ӽ
-        ImGui::SetCursorScreenPos(region.pos);
-        ImGui::InvisibleButton(region.id.c_str(), region.size);
-
-        // ͣ
-        region.state.isHovered = ImGui::IsItemHovered();
-
-        // 
-        if (ImGui::IsItemClicked()) {
-            // ¼
-            OnRegionClicked(region);
-        }
-    }
-
-   
-
-    // ݹ
-    for (auto& child : region.children) {
-        DrawRegion(child);
-    }
-
-    ImGui::PopID(); // ID
-}
-
-void RegionManager::OnRegionClicked(Region& region) {
-    // Ϣ
-    std::cout << "Clicked region: " << region.name << std::endl;
-
-    // н
-    ClearAllFocus(root);
-
-    // õǰΪ
-    region.state.isFocused = true;
-
-    // ϵ
-    if (!region.groupId.empty()) {
-        // 齹
-        SetGroupFocus(region.groupId);
-    }
-
-    // йϵ
-    if (region.type == REGION_LEAF && region.parent && region.parent->type == REGION_ROW) {
-        // н
-        SetRowFocus(region.parent->id);
-    }
-}
-
-void RegionManager::ClearAllFocus(Region& region) {
-    region.state.isFocused = false;
-    for (auto& child : region.children) {
-        ClearAllFocus(child);
-    }
-}
-
-void RegionManager::SetGroupFocus(const std::string& groupId) {
-    // ҵƥID
-    ForEachRegion(root, [&](Region& r) {
-        if (r.groupId == groupId && r.type == REGION_LEAF) {
-            r.state.isFocused = true;
-        }
-        });
-}
-
-void RegionManager::SetRowFocus(const std::string& rowId) {
-    // ҵƥID
-    ForEachRegion(root, [&](Region& r) {
-        if (r.parent && r.parent->id == rowId && r.type == REGION_LEAF) {
-            r.state.isFocused = true;
-        }
-        });
-}
-
-void RegionManager::ForEachRegion(Region& region, const std::function<void(Region&)>& func) {
-    func(region);
-    for (auto& child : region.children) {
-        ForEachRegion(child, func);
-    }
-}
-
-RegionManager::RegionManager() {
-    CreateLayout();
-}
-
-void RegionManager::ReloadConfig() {
-    root = Region();
-    root.children.clear();
-    CreateLayout();
-}
-
-void RegionManager::DrawUI() {
-    // ȡ
-    ImVec2 contentPos = ImGui::GetCursorScreenPos();
-    ImVec2 contentSize = ImGui::GetContentRegionAvail();
-
-    // Сߴ
-    if (contentSize.x < 400) contentSize.x = 400;
-    if (contentSize.y < 300) contentSize.y = 300;
-
-    // ²
-    UpdateLayout(root, contentPos, contentSize);
-
-    // 
-    DrawRegion(root);
+#include "RegionManager.h"
+#include "LayoutLoader.h"
+#include "LogSink.h"
+#include "RegionSnapshot.h"
+#include "Profiler.h"
+#include "AllocationTracker.h"
+#include "TaskPool.h"
+#include "ImGuiThreading.h"
+#include <algorithm>
+#include <cstdio>
+
+void RegionFocusSet::Reset(size_t regionCount) {
+    const size_t words = (regionCount + 63) / 64;
+    bits.assign(words, 0);
+    nextBits.assign(words, 0);
+    focused.clear();
+    nextFocused.clear();
+    changed.clear();
+}
+
+void RegionFocusSet::BeginUpdate() {
+    // nextBits在Commit后总是全零
+    nextFocused.clear();
+}
+
+void RegionFocusSet::Add(RegionHandle region) {
+    unsigned long long& word = nextBits[region >> 6];
+    const unsigned long long mask = 1ull << (region & 63);
+    if (word & mask) return;
+    word |= mask;
+    nextFocused.push_back(region);
+}
+
+const std::vector<RegionHandle>& RegionFocusSet::Commit() {
+    changed.clear();
+    for (RegionHandle region : focused) {
+        if (!TestBit(nextBits, region)) changed.push_back(region); // 失去焦点
+    }
+    for (RegionHandle region : nextFocused) {
+        if (!TestBit(bits, region)) changed.push_back(region);     // 获得焦点
+    }
+
+    // 只清除旧焦点所在的位，再交换两组位集
+    for (RegionHandle region : focused) {
+        bits[region >> 6] = 0;
+    }
+    bits.swap(nextBits);
+    focused.swap(nextFocused);
+    return changed;
+}
+
+RegionHandle RegionManager::CreateRegion(RegionHandle parent, RegionType type,
+    const std::string& name, const std::string& groupId) {
+    return tree.AddRegion(parent, type, idGen.GetID(name), name, groupId);
+}
+
+void RegionManager::CreateLayout() {
+    // 创建根区域
+    RegionHandle root = tree.AddRegion(INVALID_REGION, REGION_ROOT, "root", "Root");
+
+    // 第一行
+    RegionHandle row1 = CreateRegion(root, REGION_ROW, "Row1");
+
+    // 第一行的叶子区域
+    CreateRegion(row1, REGION_LEAF, "A1");
+    CreateRegion(row1, REGION_LEAF, "A2");
+
+    // 第二行
+    RegionHandle row2 = CreateRegion(root, REGION_ROW, "Row2");
+
+    // A1组
+    RegionHandle groupA1 = CreateRegion(row2, REGION_GROUP, "A1 Group", "A1");
+
+    // A1组的叶子区域
+    CreateRegion(groupA1, REGION_LEAF, "A1B1", "A1");
+    CreateRegion(groupA1, REGION_LEAF, "A1B2", "A1");
+
+    // A2组
+    RegionHandle groupA2 = CreateRegion(row2, REGION_GROUP, "A2 Group", "A2");
+
+    // A2组的叶子区域
+    CreateRegion(groupA2, REGION_LEAF, "A2B1", "A2");
+    CreateRegion(groupA2, REGION_LEAF, "A2B2", "A2");
+    CreateRegion(groupA2, REGION_LEAF, "A2B3", "A2");
+
+    tree.BuildMembership();
+}
+
+bool RegionManager::UpdateLayout(const ImVec2& pos, const ImVec2& size) {
+    // 一遍顺序执行布局程序，未变化的子树只检查一次脏标记
+    bool moved = program.PlaceRoot(tree, pos, size);
+    moved |= program.Run(tree, 0, program.GetSplitCount());
+    return moved;
+}
+
+bool RegionManager::UpdateLayoutParallel(const ImVec2& pos, const ImVec2& size) {
+    // 展开的区域只执行自身的分割指令，按先序串行执行（父区域总在子区域之前），
+    // 未展开的子树并行执行各自连续的指令区段
+    bool moved = program.PlaceRoot(tree, pos, size);
+    for (const RegionTask& task : tasks) {
+        if (!task.expanded) continue;
+        const int split = program.FindSplit(task.region);
+        moved |= program.Run(tree, split, split + 1);
+    }
+
+    taskMoved.assign(tasks.size(), 0);
+    taskPool->ParallelFor(static_cast<int>(tasks.size()), [&](int index, int) {
+        const RegionTask& task = tasks[index];
+        const int split = program.FindSplit(task.region);
+        if (task.expanded || split < 0) return;
+        taskMoved[index] = program.Run(tree, split, program.GetSubtreeEnd(split));
+    });
+    for (unsigned char taskMovedFlag : taskMoved) {
+        moved |= taskMovedFlag != 0;
+    }
+    return moved;
+}
+
+static bool IsCulled(const ImVec2& pos, const ImVec2& size, const ImVec4& clipRect) {
+    return pos.x >= clipRect.z || pos.y >= clipRect.w ||
+        pos.x + size.x <= clipRect.x || pos.y + size.y <= clipRect.y;
+}
+
+void RegionManager::DrawRegionSelf(RegionHandle region, const RegionDrawKey& frameKey, const ImFont* font,
+    int worker, std::vector<RegionHandle>& out) {
+    // 跳过根区域
+    if (tree.type[region] == REGION_ROOT) return;
+
+    // 计算颜色
+    const int binding = regionBinding[region];
+    ImColor color;
+    if (focus.IsFocused(region)) {
+        color = ImColor(1.0f, 0.7f, 0.4f, 1.0f); // 焦点色: 淡橘色
+    }
+    else if (tree.state[region].isHovered) {
+        color = ImColor(0.95f, 0.95f, 0.95f, 1.0f); // 悬停色: 浅灰色
+    }
+    else if (binding >= 0 && liveBindings[binding].statusColor) {
+        color = ImColor(liveBindings[binding].statusColor); // 实时数据的状态色
+    }
+    else {
+        color = ImColor(0.92f, 0.92f, 0.92f, 1.0f); // 默认色: 接近白色的灰色
+    }
+
+    // 键未变化时沿用缓存的几何
+    RegionDrawKey key = frameKey;
+    key.pos = tree.pos[region];
+    key.size = tree.size[region];
+    key.color = color;
+    const std::string_view label = binding >= 0
+        ? std::string_view(liveBindings[binding].label, liveBindings[binding].labelLength)
+        : tree.name[region];
+    geometry.Update(region, key, label, font, worker);
+    out.push_back(region);
+}
+
+void RegionManager::DrawRegion(RegionHandle region, const RegionDrawKey& frameKey, const ImFont* font,
+    int worker, std::vector<RegionHandle>& out) {
+    // 视口裁剪：子区域都在父区域内，不可见时整棵子树跳过
+    if (IsCulled(tree.pos[region], tree.size[region], frameKey.clipRect)) return;
+
+    DrawRegionSelf(region, frameKey, font, worker, out);
+
+    // 递归绘制子区域
+    for (RegionHandle child = tree.firstChild[region]; child != INVALID_REGION;
+        child = tree.nextSibling[child]) {
+        DrawRegion(child, frameKey, font, worker, out);
+    }
+}
+
+void RegionManager::DrawRegionsParallel(const RegionDrawKey& frameKey, const ImFont* font) {
+    // 展开的区域按先序串行裁剪，祖先不可见的任务整体跳过（与串行递归的剪枝一致）
+    taskVisible.resize(tasks.size());
+    for (size_t t = 0; t < tasks.size(); t++) {
+        const RegionTask& task = tasks[t];
+        const bool parentVisible = task.parentTask < 0 || taskVisible[task.parentTask];
+        taskVisible[t] = parentVisible &&
+            (!task.expanded || !IsCulled(tree.pos[task.region], tree.size[task.region], frameKey.clipRect));
+    }
+
+    // 各任务细分到自己线程的临时列表，可见区域写入各自的输出槽
+    taskPool->ParallelFor(static_cast<int>(tasks.size()), [&](int index, int worker) {
+        std::vector<RegionHandle>& out = taskRegions[index];
+        out.clear();
+        if (!taskVisible[index]) return;
+        const RegionTask& task = tasks[index];
+        if (task.expanded) {
+            DrawRegionSelf(task.region, frameKey, font, worker, out);
+        }
+        else {
+            DrawRegion(task.region, frameKey, font, worker, out);
+        }
+    });
+
+    // 按任务顺序合并，即先序绘制顺序
+    for (const std::vector<RegionHandle>& regions : taskRegions) {
+        visibleRegions.insert(visibleRegions.end(), regions.begin(), regions.end());
+    }
+}
+
+void RegionManager::BuildTasks() {
+    tasks.clear();
+    const RegionHandle root = tree.Root();
+    if (!taskPool || root == INVALID_REGION || tree.Size() < PARALLEL_MIN_REGIONS) return;
+
+    // 子树大小（父区域总是先于子区域创建）
+    std::vector<int> subtreeSize(tree.Size(), 1);
+    for (size_t i = tree.Size(); i-- > 1;) {
+        if (tree.parent[i] != INVALID_REGION) subtreeSize[tree.parent[i]] += subtreeSize[i];
+    }
+
+    // 子树大于grain的区域展开，任务数约为线程数的若干倍，不均衡的部分由工作窃取平衡
+    const int grain = std::max(1, subtreeSize[root] / (taskPool->GetThreadCount() * TASKS_PER_THREAD));
+    AddTasks(root, -1, grain, subtreeSize);
+    if (tasks.size() < 2) {
+        tasks.clear();
+        return;
+    }
+    taskRegions.resize(tasks.size());
+}
+
+void RegionManager::AddTasks(RegionHandle region, int parentTask, int grain, const std::vector<int>& subtreeSize) {
+    const int task = static_cast<int>(tasks.size());
+    const bool expanded = subtreeSize[region] > grain && tree.childCount[region] > 0;
+    tasks.push_back({ region, parentTask, expanded });
+    if (!expanded) return;
+
+    for (RegionHandle child = tree.firstChild[region]; child != INVALID_REGION; child = tree.nextSibling[child]) {
+        AddTasks(child, task, grain, subtreeSize);
+    }
+}
+
+void RegionManager::SetConstraint(RegionHandle region, const RegionConstraint& constraint) {
+    tree.SetConstraint(region, constraint);
+}
+
+void RegionManager::SetWorkerThreads(int threadCount) {
+    taskPool.reset();
+    if (threadCount != 1) {
+        taskPool = std::make_unique<TaskPool>(threadCount);
+    }
+    geometry.SetWorkerCount(taskPool ? taskPool->GetThreadCount() : 1);
+    BuildTasks();
+}
+
+void RegionManager::OnRegionClicked(RegionHandle region) {
+    // 输出点击信息（异步写日志，不在渲染线程上刷新输出）
+    const std::string_view name = tree.name[region];
+    LogSink::Writef("Clicked region: %.*s", static_cast<int>(name.size()), name.data());
+
+    // 设置焦点
+    SelectRegion(region);
+}
+
+const std::vector<RegionHandle>& RegionManager::SelectRegion(RegionHandle region) {
+    if (!tree.HasMembership()) tree.BuildMembership();
+
+    focus.BeginUpdate();
+
+    // 设置当前区域为焦点
+    focus.Add(region);
+
+    // 处理组关系
+    const int group = tree.groupIndex[region];
+    if (group >= 0) {
+        // 设置组焦点
+        for (int i = tree.groupMemberStart[group]; i < tree.groupMemberStart[group + 1]; i++) {
+            focus.Add(tree.groupMembers[i]);
+        }
+    }
+
+    // 处理行关系
+    const int row = tree.rowIndex[region];
+    if (tree.IsLeaf(region) && row >= 0) {
+        // 设置行焦点
+        for (int i = tree.rowMemberStart[row]; i < tree.rowMemberStart[row + 1]; i++) {
+            focus.Add(tree.rowMembers[i]);
+        }
+    }
+
+    return focus.Commit();
+}
+
+RegionManager::RegionManager() {
+    CreateLayout();
+    OnTreeReplaced();
+}
+
+RegionManager::~RegionManager() = default;
+
+void RegionManager::WatchLayoutFile(const std::string& path) {
+    // 加载完成前继续显示当前布局
+    layoutWatcher = std::make_unique<LayoutWatcher>(path);
+}
+
+bool RegionManager::HasPendingLayout() const {
+    return layoutWatcher && layoutWatcher->HasResult();
+}
+
+bool RegionManager::HasPendingLiveData() const {
+    for (const LiveFeed& feed : liveFeeds) {
+        if (feed.data->HasNewSnapshot()) return true;
+    }
+    return false;
+}
+
+void RegionManager::SetTree(RegionTree&& newTree) {
+    tree = std::move(newTree);
+    OnTreeReplaced();
+}
+
+bool RegionManager::SaveSnapshot(const std::string& path, std::string* error) const {
+    return WriteRegionSnapshot(path, tree, error);
+}
+
+bool RegionManager::LoadSnapshot(const std::string& path, std::string* error) {
+    RegionTree loaded;
+    if (!LoadRegionSnapshot(path, loaded, error)) return false;
+    SetTree(std::move(loaded));
+    return true;
+}
+
+void RegionManager::ReloadConfig() {
+    if (layoutWatcher) {
+        // 由后台线程重新解析，下一帧边界生效
+        layoutWatcher->RequestReload();
+        return;
+    }
+    tree.Clear();
+    CreateLayout();
+    OnTreeReplaced();
+}
+
+void RegionManager::ApplyPendingLayout() {
+    if (!layoutWatcher) return;
+    std::unique_ptr<LayoutLoadResult> result = layoutWatcher->TakeResult();
+    if (!result) return;
+
+    if (!result->tree) {
+        // 解析失败时保留当前布局
+        LogSink::Writef("Layout reload failed: %s", result->error.c_str());
+        return;
+    }
+
+    // 整棵树交换，旧树交给后台线程释放
+    auto oldTree = std::make_unique<RegionTree>(std::move(tree));
+    tree = std::move(*result->tree);
+    layoutWatcher->Retire(std::move(oldTree));
+    OnTreeReplaced();
+}
+
+void RegionManager::OnTreeReplaced() {
+    // 新树的句柄与旧树无关，重置依赖句柄的状态
+    if (!tree.HasMembership()) tree.BuildMembership();
+    program.Compile(tree);
+    focus.Reset(tree.Size());
+    geometry.Reset(tree.Size());
+    hoveredRegion = INVALID_REGION;
+    layoutGeneration++;
+    BuildTasks();
+    RebindLiveData();
+}
+
+void RegionManager::AddLiveData(RegionLiveData* data) {
+    if (!data) return;
+    for (const LiveFeed& feed : liveFeeds) {
+        if (feed.data == data) return;
+    }
+    liveFeeds.push_back({ data, std::vector<int>(data->GetCapacity(), -1), 0 });
+    RebindLiveData();
+}
+
+void RegionManager::RemoveLiveData(RegionLiveData* data) {
+    auto it = std::find_if(liveFeeds.begin(), liveFeeds.end(),
+        [data](const LiveFeed& feed) { return feed.data == data; });
+    if (it == liveFeeds.end()) return;
+
+    // 之前绑定的区域恢复显示名称
+    for (const LiveBinding& binding : liveBindings) {
+        geometry.Invalidate(binding.region);
+    }
+    liveFeeds.erase(it);
+    RebindLiveData();
+}
+
+void RegionManager::RebindLiveData() {
+    // 按当前区域树重新解析所有数据源已取得的通道
+    liveBindings.clear();
+    regionBinding.assign(tree.Size(), -1);
+    for (int f = 0; f < static_cast<int>(liveFeeds.size()); f++) {
+        LiveFeed& feed = liveFeeds[f];
+        std::fill(feed.channelBinding.begin(), feed.channelBinding.end(), -1);
+        const int channelCount = feed.data->GetSnapshot().channelCount;
+        for (feed.boundChannels = 0; feed.boundChannels < channelCount; feed.boundChannels++) {
+            BindLiveChannel(f, feed.boundChannels);
+        }
+    }
+}
+
+void RegionManager::BindLiveChannel(int feed, int channel) {
+    LiveFeed& liveFeed = liveFeeds[feed];
+    const RegionHandle region = tree.FindRegion(liveFeed.data->GetChannelId(channel));
+    if (region == INVALID_REGION) {
+        liveFeed.channelBinding[channel] = -1;
+        return;
+    }
+
+    // 同一区域被多个通道绑定时以最后解析的通道为准
+    int binding = regionBinding[region];
+    if (binding < 0) {
+        binding = static_cast<int>(liveBindings.size());
+        liveBindings.emplace_back();
+        regionBinding[region] = binding;
+    }
+    else {
+        const LiveBinding& previous = liveBindings[binding];
+        liveFeeds[previous.feed].channelBinding[previous.channel] = -1;
+    }
+    LiveBinding& liveBinding = liveBindings[binding];
+    liveBinding.region = region;
+    liveBinding.feed = feed;
+    liveBinding.channel = channel;
+    liveFeed.channelBinding[channel] = binding;
+    RefreshLiveBinding(binding);
+}
+
+void RegionManager::RefreshLiveBinding(int binding) {
+    if (binding < 0) return;
+    LiveBinding& liveBinding = liveBindings[binding];
+    const RegionLiveValue& value = liveFeeds[liveBinding.feed].data->GetSnapshot().values[liveBinding.channel];
+
+    // 标签为“名称: 数值 文字”，只在值变化时格式化
+    const std::string_view name = tree.name[liveBinding.region];
+    const std::string_view text = value.GetText();
+    const bool hasNumber = (value.flags & RegionLiveValue::HAS_NUMBER) != 0;
+    const bool hasText = (value.flags & RegionLiveValue::HAS_TEXT) != 0;
+    int length;
+    if (hasNumber && hasText) {
+        length = std::snprintf(liveBinding.label, LIVE_LABEL_CAPACITY, "%.*s: %.6g %.*s",
+            static_cast<int>(name.size()), name.data(), value.number, static_cast<int>(text.size()), text.data());
+    }
+    else if (hasNumber) {
+        length = std::snprintf(liveBinding.label, LIVE_LABEL_CAPACITY, "%.*s: %.6g",
+            static_cast<int>(name.size()), name.data(), value.number);
+    }
+    else if (hasText) {
+        length = std::snprintf(liveBinding.label, LIVE_LABEL_CAPACITY, "%.*s: %.*s",
+            static_cast<int>(name.size()), name.data(), static_cast<int>(text.size()), text.data());
+    }
+    else {
+        length = std::snprintf(liveBinding.label, LIVE_LABEL_CAPACITY, "%.*s",
+            static_cast<int>(name.size()), name.data());
+    }
+    liveBinding.labelLength = std::clamp(length, 0, LIVE_LABEL_CAPACITY - 1);
+    liveBinding.statusColor = (value.flags & RegionLiveValue::HAS_COLOR) ? value.statusColor : 0;
+
+    geometry.Invalidate(liveBinding.region);
+    liveChangedCount++;
+}
+
+void RegionManager::UpdateLiveData() {
+    liveChangedCount = 0;
+    for (int f = 0; f < static_cast<int>(liveFeeds.size()); f++) {
+        LiveFeed& feed = liveFeeds[f];
+        if (!feed.data->Acquire()) continue;
+        const RegionLiveSnapshot& snapshot = feed.data->GetSnapshot();
+
+        // 已解析的通道按变化列表刷新，新注册的通道在解析时刷新
+        const int boundChannels = feed.boundChannels;
+        if (snapshot.fullRefresh) {
+            for (int channel = 0; channel < boundChannels; channel++) {
+                RefreshLiveBinding(feed.channelBinding[channel]);
+            }
+        }
+        else {
+            for (int channel : snapshot.changed) {
+                if (channel < boundChannels) RefreshLiveBinding(feed.channelBinding[channel]);
+            }
+        }
+        for (; feed.boundChannels < snapshot.channelCount; feed.boundChannels++) {
+            BindLiveChannel(f, feed.boundChannels);
+        }
+    }
+}
+
+void RegionManager::UpdateHover(RegionHandle region) {
+    if (region == hoveredRegion) return;
+    if (hoveredRegion != INVALID_REGION) tree.state[hoveredRegion].isHovered = false;
+    if (region != INVALID_REGION) tree.state[region].isHovered = true;
+    hoveredRegion = region;
+}
+
+void RegionManager::DrawUI() {
+    PROFILE_SCOPE("RegionManager::DrawUI");
+    ALLOC_SCOPE("RegionManager::DrawUI");
+
+    // 帧边界：换入后台加载好的布局
+    ApplyPendingLayout();
+
+    // 获取窗口内容区域
+    ImVec2 contentPos = ImGui::GetCursorScreenPos();
+    ImVec2 contentSize = ImGui::GetContentRegionAvail();
+
+    // 设置最小区域尺寸
+    if (contentSize.x < 400) contentSize.x = 400;
+    if (contentSize.y < 300) contentSize.y = 300;
+
+    // 更新布局
+    const RegionHandle root = tree.Root();
+    if (root == INVALID_REGION) return;
+    {
+        PROFILE_SCOPE("Layout");
+        ALLOC_SCOPE("Layout");
+        // 约束变化后重新编译布局程序
+        if (program.GetTreeVersion() != tree.GetLayoutVersion()) program.Compile(tree);
+        const bool moved = tasks.empty()
+            ? UpdateLayout(contentPos, contentSize)
+            : UpdateLayoutParallel(contentPos, contentSize);
+        if (moved) layoutGeneration++;
+
+        // 布局变化后重建空间索引
+        if (gridGeneration != layoutGeneration) {
+            grid.Build(tree);
+            gridGeneration = layoutGeneration;
+        }
+    }
+
+    // 整张区域图只提交一个交互项，悬停/点击通过空间索引查询
+    ImGui::SetCursorScreenPos(contentPos);
+    ImGui::InvisibleButton("##regions", contentSize);
+    const RegionHandle hovered = ImGui::IsItemHovered()
+        ? grid.HitTest(tree, ImGui::GetIO().MousePos)
+        : INVALID_REGION;
+    UpdateHover(hovered);
+    if (hovered != INVALID_REGION && ImGui::IsItemClicked()) {
+        // 处理点击事件
+        OnRegionClicked(hovered);
+    }
+
+    // 本帧公共的绘制参数
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    ImFont* font = ImGui::GetIO().Fonts->Fonts[0];
+    RegionDrawKey frameKey;
+    frameKey.clipRect = drawList->_CmdHeader.ClipRect;
+    frameKey.fontSize = font->FontSize * ImGui::GetIO().FontGlobalScale;
+    frameKey.textureId = drawList->_CmdHeader.TextureId;
+    frameKey.drawListFlags = drawList->Flags;
+
+    // 收集可见区域（只有键变化的区域重新细分），再整批追加到窗口绘制列表
+    PROFILE_SCOPE("Geometry");
+    ALLOC_SCOPE("Geometry");
+    UpdateLiveData(); // 换入实时数据的最新快照，有新值的区域失效
+    visibleRegions.clear();
+    geometry.ResetFrameStats();
+    geometry.SetDrawListSharedData(ImGui::GetDrawListSharedData());
+    // 工作线程细分时ImDrawList经ImGui::MemAlloc分配，只有GImGui为线程局部变量（工作线程没有当前上下文）时
+    // 才不会并发修改调用线程的上下文，否则几何在调用线程上串行细分（布局仍然并行）
+    if (tasks.empty() || !IsImGuiContextThreadLocal()) {
+        DrawRegion(root, frameKey, font, 0, visibleRegions);
+    }
+    else {
+        DrawRegionsParallel(frameKey, font);
+    }
+    geometry.Append(drawList, visibleRegions);
 }
\ No newline at end of file
@@ -1,74 +1,153 @@
-#pragma once
-#pragma once
-
-#include <vector>
-#include <string>
-#include <functional>
-#include "imgui.h"
-
-// 
-enum RegionType {
-    REGION_ROOT,    // 
-    REGION_ROW,     // 
-    REGION_GROUP,   // 
-    REGION_LEAF     // Ҷ
-};
-
-// ״̬
-struct RegionState {
-    bool isHovered = false;
-    bool isFocused = false;
-};
-
-// ṹ
-struct Region {
-    std::string id;          // Ψһʶ
-    std::string name;        // 
-    RegionType type;         // 
-    ImVec2 pos;              // λ
-    ImVec2 size;             // С
-    RegionState state;       // ״̬
-    std::vector<Region> children; // 
-    Region* parent = nullptr;    // ָ
-    std::string groupId;     // ID
-
-    // жǷҶӽڵ
-    bool IsLeaf() const;
-
-    // 
-    Region* FindRegion(const std::string& targetId);
-};
-
-// ΨһID
-class IDGenerator {
-private:
-    int counter = 0;
-public:
-    std::string GetID(const std::string& prefix);
-};
-// 
-class RegionManager {
-private:
-    Region root;  // 
-    IDGenerator idGen; // ID
-
-    // 
-    Region CreateRegion(Region& parent, RegionType type,
-        const std::string& name, const std::string& groupId = "");
-
-    // ĺ
-    void CreateLayout();
-    void UpdateLayout(Region& region, const ImVec2& pos, const ImVec2& size);
-    void DrawRegion(Region& region);
-    void OnRegionClicked(Region& region);
-    void ClearAllFocus(Region& region);
-    void SetGroupFocus(const std::string& groupId);
-    void SetRowFocus(const std::string& rowId);
-    void ForEachRegion(Region& region, const std::function<void(Region&)>& func);
-
-public:
-    RegionManager();
-    void ReloadConfig();
-    void DrawUI();
-};
-
+#pragma once
+#pragma once
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include "RegionTree.h"
+#include "RegionSpatialGrid.h"
+#include "RegionGeometryCache.h"
+#include "LayoutProgram.h"
+#include "RegionLiveData.h"
+
+// 焦点集合：稠密位集 + 当前焦点列表，更新时只触及状态变化的区域
+class RegionFocusSet {
+private:
+    std::vector<unsigned long long> bits;     // 当前焦点位集
+    std::vector<unsigned long long> nextBits; // 正在构建的焦点位集
+    std::vector<RegionHandle> focused;        // 当前焦点列表
+    std::vector<RegionHandle> nextFocused;    // 正在构建的焦点列表
+    std::vector<RegionHandle> changed;        // 最近一次更新的焦点差异
+
+    static bool TestBit(const std::vector<unsigned long long>& set, RegionHandle region) {
+        return (set[region >> 6] >> (region & 63)) & 1;
+    }
+
+public:
+    void Reset(size_t regionCount);
+    bool IsFocused(RegionHandle region) const { return TestBit(bits, region); }
+
+    // 构建新的焦点集合：BeginUpdate -> Add... -> Commit
+    void BeginUpdate();
+    void Add(RegionHandle region);
+    const std::vector<RegionHandle>& Commit(); // 返回焦点状态发生变化的区域
+
+    const std::vector<RegionHandle>& GetFocused() const { return focused; }
+    const std::vector<RegionHandle>& GetChanged() const { return changed; }
+};
+
+class LayoutWatcher;
+class TaskPool;
+
+// 区域管理器
+class RegionManager {
+private:
+    RegionTree tree;   // 区域树
+    IDGenerator idGen; // ID生成器
+    unsigned int layoutGeneration = 0; // 布局代数，有区域移动时递增
+    LayoutProgram program;             // 编译后的布局程序
+    std::unique_ptr<LayoutWatcher> layoutWatcher; // 布局文件监视器
+    RegionFocusSet focus;              // 焦点状态
+    RegionHandle hoveredRegion = INVALID_REGION; // 当前悬停的叶子
+    RegionSpatialGrid grid;            // 命中检测用的空间索引
+    unsigned int gridGeneration = ~0u; // 空间索引对应的布局代数
+    RegionGeometryCache geometry;      // 区域几何缓存
+    std::vector<RegionHandle> visibleRegions; // 本帧可见区域（绘制顺序）
+
+    // 并行布局/绘制的任务：区域树按先序切分，展开的任务只处理区域本身（子区域由后面的任务处理），
+    // 未展开的任务处理整棵子树。按任务顺序合并各任务的输出即得到与串行递归相同的先序结果
+    struct RegionTask {
+        RegionHandle region;
+        int parentTask;     // 父区域所在的展开任务，-1表示根区域
+        bool expanded;
+    };
+    static constexpr size_t PARALLEL_MIN_REGIONS = 4096; // 区域数少于该值时串行
+    static constexpr int TASKS_PER_THREAD = 8;           // 每个线程平均分到的任务数
+    std::unique_ptr<TaskPool> taskPool;     // 为空时串行布局/绘制
+    std::vector<RegionTask> tasks;          // 为空时串行布局/绘制
+    std::vector<unsigned char> taskMoved;   // 各任务的子树是否有区域移动
+    std::vector<unsigned char> taskVisible; // 各任务的祖先（展开任务还包括自身）是否可见
+    std::vector<std::vector<RegionHandle>> taskRegions; // 各任务收集的可见区域
+
+    // 实时数据：各数据源的通道按区域ID绑定到区域，标签和状态色只在换入的快照列出该通道时重新生成
+    static constexpr int LIVE_LABEL_CAPACITY = 96;
+    struct LiveFeed {
+        RegionLiveData* data;
+        std::vector<int> channelBinding; // 通道 -> liveBindings下标，-1表示没有对应的区域
+        int boundChannels = 0;           // 已按ID解析的通道数
+    };
+    struct LiveBinding {
+        RegionHandle region;
+        int feed;
+        int channel;
+        ImU32 statusColor;
+        int labelLength;
+        char label[LIVE_LABEL_CAPACITY];
+    };
+    std::vector<LiveFeed> liveFeeds;
+    std::vector<LiveBinding> liveBindings;
+    std::vector<int> regionBinding; // 区域 -> liveBindings下标，-1表示没有绑定
+    int liveChangedCount = 0;       // 本帧取得新值的区域数
+
+    // 辅助函数：创建区域
+    RegionHandle CreateRegion(RegionHandle parent, RegionType type,
+        const std::string& name, const std::string& groupId = "");
+
+    // 核心函数
+    void CreateLayout();
+    bool UpdateLayout(const ImVec2& pos, const ImVec2& size); // 返回是否有区域移动
+    bool UpdateLayoutParallel(const ImVec2& pos, const ImVec2& size);
+    void DrawRegionSelf(RegionHandle region, const RegionDrawKey& frameKey, const ImFont* font,
+        int worker, std::vector<RegionHandle>& out);
+    void DrawRegion(RegionHandle region, const RegionDrawKey& frameKey, const ImFont* font,
+        int worker, std::vector<RegionHandle>& out);
+    void DrawRegionsParallel(const RegionDrawKey& frameKey, const ImFont* font);
+    void BuildTasks();
+    void AddTasks(RegionHandle region, int parentTask, int grain, const std::vector<int>& subtreeSize);
+    void OnRegionClicked(RegionHandle region);
+    void ApplyPendingLayout();
+    void OnTreeReplaced();
+    void UpdateHover(RegionHandle region);
+    void UpdateLiveData();
+    void BindLiveChannel(int feed, int channel);
+    void RefreshLiveBinding(int binding);
+    void RebindLiveData();
+
+public:
+    RegionManager();
+    ~RegionManager();
+    void WatchLayoutFile(const std::string& path); // 从文件加载布局并监视修改
+    void SetTree(RegionTree&& newTree);            // 直接替换区域树（如程序生成的布局）
+    bool SaveSnapshot(const std::string& path, std::string* error = nullptr) const; // 保存当前区域树的二进制快照
+    bool LoadSnapshot(const std::string& path, std::string* error = nullptr);       // 从快照替换区域树
+    void ReloadConfig();
+    void AddLabelFonts(ImFontAtlas* atlas, float pixelScale) { geometry.AddLabelFonts(atlas, pixelScale); } // 在字体图集构建之前调用
+    void DrawUI();
+    bool HasPendingLayout() const;                 // 后台是否已加载好待应用的新布局
+    bool HasPendingLiveData() const;               // 是否有数据源发布了尚未换入的快照
+
+    // 布局和几何细分的线程数，1表示串行，0表示使用全部硬件线程
+    // 区域数达到PARALLEL_MIN_REGIONS时才并行，结果与串行完全相同
+    // 几何细分只在ImGui以线程局部的当前上下文编译时并行（见ImGuiThreading.h）
+    void SetWorkerThreads(int threadCount);
+
+    // 设置区域的布局权重和最小/最大尺寸，下一帧生效
+    void SetConstraint(RegionHandle region, const RegionConstraint& constraint);
+
+    // 绑定实时数据源：每帧DrawUI时换入最新快照，只重新细分有新值的区域。
+    // 通道按区域ID对应区域（布局重新加载后重新解析），数据源须在移除或RegionManager析构之前一直有效
+    void AddLiveData(RegionLiveData* data);
+    void RemoveLiveData(RegionLiveData* data);
+    int GetLiveChangedCount() const { return liveChangedCount; } // 本帧取得新值的区域数
+
+    RegionHandle FindRegion(std::string_view id) const { return tree.FindRegion(id); }
+    const RegionTree& GetTree() const { return tree; }
+
+    // 选中区域（同组叶子、同行叶子一并获得焦点），返回焦点发生变化的区域
+    const std::vector<RegionHandle>& SelectRegion(RegionHandle region);
+    bool IsFocused(RegionHandle region) const { return focus.IsFocused(region); }
+    const std::vector<RegionHandle>& GetFocusDiff() const { return focus.GetChanged(); }
+    const RegionGeometryCache& GetGeometryCache() const { return geometry; }
+    unsigned int GetLayoutGeneration() const { return layoutGeneration; }
+};
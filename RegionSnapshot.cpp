@@ -0,0 +1,279 @@
+#include "RegionSnapshot.h"
+#include "RegionSnapshotFormat.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+bool Fail(std::string* error, const std::string& message) {
+    if (error) *error = message;
+    return false;
+}
+
+// 字符串表：重复的名称/组ID只存一份，偏移0为空字符串
+class StringTableWriter {
+public:
+    StringTableWriter() { bytes.push_back('\0'); }
+
+    uint32_t Add(std::string_view str) {
+        if (str.empty()) return 0;
+        auto it = offsets.find(str);
+        if (it != offsets.end()) return it->second;
+        const uint32_t offset = static_cast<uint32_t>(bytes.size());
+        bytes.insert(bytes.end(), str.begin(), str.end());
+        bytes.push_back('\0');
+        offsets.emplace(str, offset);
+        return offset;
+    }
+
+    const std::vector<char>& Bytes() const { return bytes; }
+
+private:
+    std::vector<char> bytes;
+    std::unordered_map<std::string_view, uint32_t> offsets; // 键引用源树的字符串
+};
+
+template<typename T>
+void WriteArray(std::vector<char>& out, uint64_t offset, const T* data, size_t count) {
+    if (count > 0) std::memcpy(out.data() + offset, data, count * sizeof(T));
+}
+
+// 校验句柄和链表：父区域先于子区域、兄弟链表递增且长度与childCount一致，保证遍历有界
+// 先检查所有区域的父区域和兄弟指针，再遍历子区域链表：兄弟指针都已确认严格递增，
+// 任何链表（包括构造的环）都在count步内结束
+bool ValidateLinks(const RegionTree& tree, std::string* error) {
+    const int count = static_cast<int>(tree.Size());
+    auto inRange = [count](RegionHandle handle) { return handle >= 0 && handle < count; };
+    for (int i = 0; i < count; i++) {
+        const RegionHandle parent = tree.parent[i];
+        if (i == 0 ? parent != INVALID_REGION : !(parent >= 0 && parent < i)) {
+            return Fail(error, "invalid parent of region " + std::to_string(i));
+        }
+        const RegionHandle next = tree.nextSibling[i];
+        if (next != INVALID_REGION && !(next > i && next < count && tree.parent[next] == parent)) {
+            return Fail(error, "invalid sibling of region " + std::to_string(i));
+        }
+    }
+
+    // 每个区域只属于一条兄弟链表，逐条遍历的总代价为O(n)
+    for (int i = 0; i < count; i++) {
+        const RegionHandle first = tree.firstChild[i];
+        RegionHandle last = INVALID_REGION;
+        int children = 0;
+        for (RegionHandle child = first; child != INVALID_REGION; child = tree.nextSibling[child]) {
+            if (!inRange(child) || child <= i || tree.parent[child] != i) {
+                return Fail(error, "invalid child list of region " + std::to_string(i));
+            }
+            last = child;
+            children++;
+        }
+        if (children != tree.childCount[i] || last != tree.lastChild[i]) {
+            return Fail(error, "inconsistent child count of region " + std::to_string(i));
+        }
+    }
+    return true;
+}
+
+bool ValidateMembers(const std::vector<int>& start, const std::vector<RegionHandle>& members,
+    int regionCount, const char* what, std::string* error) {
+    if (start.empty() || start.front() != 0 || start.back() != static_cast<int>(members.size())) {
+        return Fail(error, std::string("invalid ") + what + " member table");
+    }
+    for (size_t k = 1; k < start.size(); k++) {
+        if (start[k] < start[k - 1]) return Fail(error, std::string("invalid ") + what + " member table");
+    }
+    for (RegionHandle member : members) {
+        if (member < 0 || member >= regionCount) return Fail(error, std::string("invalid ") + what + " member");
+    }
+    return true;
+}
+
+} // namespace
+
+bool IsRegionSnapshot(std::string_view data) {
+    return data.size() >= sizeof(SnapshotHeader) && std::memcmp(data.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0;
+}
+
+bool WriteRegionSnapshot(const std::string& path, const RegionTree& tree, std::string* error) {
+    const size_t count = tree.Size();
+    const bool hasMembership = tree.HasMembership();
+
+    StringTableWriter strings;
+    std::vector<SnapshotNode> nodes(count);
+    for (size_t i = 0; i < count; i++) {
+        SnapshotNode& node = nodes[i];
+        node.idOffset = strings.Add(tree.id[i]);
+        node.nameOffset = strings.Add(tree.name[i]);
+        node.groupIdOffset = strings.Add(tree.groupId[i]);
+        node.idLength = static_cast<uint32_t>(tree.id[i].size());
+        node.nameLength = static_cast<uint32_t>(tree.name[i].size());
+        node.groupIdLength = static_cast<uint32_t>(tree.groupId[i].size());
+        node.type = tree.type[i];
+        node.parent = tree.parent[i];
+        node.firstChild = tree.firstChild[i];
+        node.lastChild = tree.lastChild[i];
+        node.nextSibling = tree.nextSibling[i];
+        node.childCount = tree.childCount[i];
+        node.posX = tree.pos[i].x;
+        node.posY = tree.pos[i].y;
+        node.sizeX = tree.size[i].x;
+        node.sizeY = tree.size[i].y;
+        node.weight = tree.constraint[i].weight;
+        node.minSize = tree.constraint[i].minSize;
+        node.maxSize = tree.constraint[i].maxSize;
+        node.groupIndex = hasMembership ? tree.groupIndex[i] : -1;
+        node.rowIndex = hasMembership ? tree.rowIndex[i] : -1;
+        node.flags = tree.layoutDirty[i] ? NODE_LAYOUT_DIRTY : 0;
+    }
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = REGION_SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.regionCount = static_cast<uint32_t>(count);
+    header.stringBytes = static_cast<uint32_t>(strings.Bytes().size());
+    if (hasMembership) {
+        header.flags = SNAPSHOT_HAS_MEMBERSHIP;
+        header.groupCount = static_cast<uint32_t>(tree.groupMemberStart.size() - 1);
+        header.rowCount = static_cast<uint32_t>(tree.rowMemberStart.size() - 1);
+        header.groupMemberCount = static_cast<uint32_t>(tree.groupMembers.size());
+        header.rowMemberCount = static_cast<uint32_t>(tree.rowMembers.size());
+    }
+
+    // 整个文件先在内存中拼好（对齐填充为0）
+    const SnapshotLayout layout(header);
+    std::vector<char> out(layout.total, 0);
+    WriteArray(out, 0, &header, 1);
+    WriteArray(out, layout.strings, strings.Bytes().data(), strings.Bytes().size());
+    WriteArray(out, layout.nodes, nodes.data(), nodes.size());
+    if (hasMembership) {
+        WriteArray(out, layout.groupStart, tree.groupMemberStart.data(), tree.groupMemberStart.size());
+        WriteArray(out, layout.groupMembers, tree.groupMembers.data(), tree.groupMembers.size());
+        WriteArray(out, layout.rowStart, tree.rowMemberStart.data(), tree.rowMemberStart.size());
+        WriteArray(out, layout.rowMembers, tree.rowMembers.data(), tree.rowMembers.size());
+    }
+    else {
+        // 空成员表也保留一个起始项
+        const int32_t zero = 0;
+        WriteArray(out, layout.groupStart, &zero, 1);
+        WriteArray(out, layout.rowStart, &zero, 1);
+    }
+
+    const std::string tempPath = path + ".tmp";
+    FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) return Fail(error, "cannot create " + tempPath);
+    const bool written = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    if (std::fclose(file) != 0 || !written) {
+        std::remove(tempPath.c_str());
+        return Fail(error, "cannot write " + tempPath);
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        std::remove(tempPath.c_str());
+        return Fail(error, "cannot rename " + tempPath + " to " + path + ": " + ec.message());
+    }
+    return true;
+}
+
+bool LoadRegionSnapshot(std::shared_ptr<const MappedFile> file, RegionTree& tree, std::string* error) {
+    tree.Clear();
+    const std::string_view data = file->View();
+    if (!IsRegionSnapshot(data)) return Fail(error, "not a region snapshot");
+
+    SnapshotHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.byteOrder != SNAPSHOT_BYTE_ORDER) return Fail(error, "snapshot written with a different byte order");
+    if (header.version != REGION_SNAPSHOT_VERSION) {
+        return Fail(error, "unsupported snapshot version " + std::to_string(header.version));
+    }
+    const SnapshotLayout layout(header);
+    if (layout.total > data.size()) return Fail(error, "truncated snapshot");
+    if (header.regionCount == 0) return Fail(error, "empty snapshot");
+
+    // 各段直接引用映射内存（映射按页对齐，段按8字节对齐）
+    const char* base = data.data();
+    const char* strings = base + layout.strings;
+    const auto* nodes = reinterpret_cast<const SnapshotNode*>(base + layout.nodes);
+    auto stringAt = [&](uint32_t offset, uint32_t length, std::string_view& out) {
+        if (uint64_t(offset) + length >= header.stringBytes || strings[offset + length] != '\0') return false;
+        out = std::string_view(strings + offset, length);
+        return true;
+    };
+
+    const int count = static_cast<int>(header.regionCount);
+    const bool hasMembership = (header.flags & SNAPSHOT_HAS_MEMBERSHIP) != 0;
+    tree.Resize(count);
+    if (hasMembership) {
+        tree.groupIndex.resize(count);
+        tree.rowIndex.resize(count);
+    }
+    for (int i = 0; i < count; i++) {
+        const SnapshotNode& node = nodes[i];
+        if (!stringAt(node.idOffset, node.idLength, tree.id[i]) ||
+            !stringAt(node.nameOffset, node.nameLength, tree.name[i]) ||
+            !stringAt(node.groupIdOffset, node.groupIdLength, tree.groupId[i])) {
+            tree.Clear();
+            return Fail(error, "invalid string of region " + std::to_string(i));
+        }
+        if (node.type < REGION_ROOT || node.type > REGION_LEAF ||
+            !(node.weight >= 0.0f && node.weight <= FLT_MAX) || !(node.minSize >= 0.0f) || !(node.maxSize >= node.minSize)) {
+            tree.Clear();
+            return Fail(error, "invalid record of region " + std::to_string(i));
+        }
+        tree.type[i] = static_cast<RegionType>(node.type);
+        tree.parent[i] = node.parent;
+        tree.firstChild[i] = node.firstChild;
+        tree.lastChild[i] = node.lastChild;
+        tree.nextSibling[i] = node.nextSibling;
+        tree.childCount[i] = node.childCount;
+        tree.pos[i] = ImVec2(node.posX, node.posY);
+        tree.size[i] = ImVec2(node.sizeX, node.sizeY);
+        tree.constraint[i] = { node.weight, node.minSize, node.maxSize };
+        tree.layoutDirty[i] = (node.flags & NODE_LAYOUT_DIRTY) ? 1 : 0;
+        if (hasMembership) {
+            tree.groupIndex[i] = node.groupIndex;
+            tree.rowIndex[i] = node.rowIndex;
+        }
+    }
+    if (!ValidateLinks(tree, error)) {
+        tree.Clear();
+        return false;
+    }
+
+    if (hasMembership) {
+        auto ints = [&](uint64_t offset) { return reinterpret_cast<const int32_t*>(base + offset); };
+        tree.groupMemberStart.assign(ints(layout.groupStart), ints(layout.groupStart) + header.groupCount + 1);
+        tree.groupMembers.assign(ints(layout.groupMembers), ints(layout.groupMembers) + header.groupMemberCount);
+        tree.rowMemberStart.assign(ints(layout.rowStart), ints(layout.rowStart) + header.rowCount + 1);
+        tree.rowMembers.assign(ints(layout.rowMembers), ints(layout.rowMembers) + header.rowMemberCount);
+        bool valid = ValidateMembers(tree.groupMemberStart, tree.groupMembers, count, "group", error) &&
+            ValidateMembers(tree.rowMemberStart, tree.rowMembers, count, "row", error);
+        for (int i = 0; valid && i < count; i++) {
+            if (tree.groupIndex[i] < -1 || tree.groupIndex[i] >= static_cast<int>(header.groupCount) ||
+                tree.rowIndex[i] < -1 || tree.rowIndex[i] >= static_cast<int>(header.rowCount)) {
+                valid = Fail(error, "invalid member index of region " + std::to_string(i));
+            }
+        }
+        if (!valid) {
+            tree.Clear();
+            return false;
+        }
+    }
+
+    tree.FinishBulkLoad(std::move(file), hasMembership);
+    return true;
+}
+
+bool LoadRegionSnapshot(const std::string& path, RegionTree& tree, std::string* error) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->Open(path)) {
+        tree.Clear();
+        return Fail(error, "cannot open " + path);
+    }
+    return LoadRegionSnapshot(std::move(file), tree, error);
+}
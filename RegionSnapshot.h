@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include "RegionTree.h"
+#include "LayoutLoader.h"
+
+// 区域树二进制快照：保存构建并布局好的区域树（字符串表、扁平节点记录、成员索引），
+// 启动时映射文件即可使用，不需要解析文本、生成ID或逐个节点分配内存。
+//
+// 文件布局（本机字节序，各段按8字节对齐）：
+//   SnapshotHeader
+//   字符串表     所有id/名称/组ID，每个以'\0'结尾（可直接传给ImGui），重复的字符串只存一份
+//   节点记录     SnapshotNode[regionCount]，下标即区域句柄
+//   成员索引     groupMemberStart[groupCount + 1]、groupMembers、rowMemberStart[rowCount + 1]、rowMembers
+//
+// 加载时校验版本、字节序、各段范围和句柄，不满足则拒绝加载；格式变化时递增SNAPSHOT_VERSION。
+
+constexpr unsigned int REGION_SNAPSHOT_VERSION = 1;
+
+// 是否为快照文件（检查文件头的魔数）
+bool IsRegionSnapshot(std::string_view data);
+
+// 写出区域树快照（先写临时文件再重命名，监视该文件的LayoutWatcher不会读到写了一半的文件）
+bool WriteRegionSnapshot(const std::string& path, const RegionTree& tree, std::string* error);
+
+// 从映射的快照加载：字符串直接引用映射内存，树持有file直到清空或销毁
+bool LoadRegionSnapshot(std::shared_ptr<const MappedFile> file, RegionTree& tree, std::string* error);
+bool LoadRegionSnapshot(const std::string& path, RegionTree& tree, std::string* error);
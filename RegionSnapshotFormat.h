@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+// 区域树快照的文件格式（RegionSnapshot.cpp内部使用，测试据此构造损坏的快照）。
+// 修改任何结构时递增REGION_SNAPSHOT_VERSION（RegionSnapshot.h）
+
+constexpr char SNAPSHOT_MAGIC[8] = { 'R', 'G', 'N', 'S', 'N', 'A', 'P', '\0' };
+constexpr uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+constexpr uint32_t SNAPSHOT_HAS_MEMBERSHIP = 1;
+constexpr uint32_t NODE_LAYOUT_DIRTY = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;         // 写入方字节序的标记
+    uint32_t regionCount;
+    uint32_t stringBytes;
+    uint32_t groupCount;
+    uint32_t rowCount;
+    uint32_t groupMemberCount;
+    uint32_t rowMemberCount;
+    uint32_t flags;             // SNAPSHOT_HAS_MEMBERSHIP
+    uint32_t reserved;
+};
+
+// 节点记录，字段与RegionTree的各数组一一对应
+struct SnapshotNode {
+    uint32_t idOffset, nameOffset, groupIdOffset;   // 字符串表中的偏移
+    uint32_t idLength, nameLength, groupIdLength;
+    int32_t type;
+    int32_t parent, firstChild, lastChild, nextSibling, childCount;
+    float posX, posY, sizeX, sizeY;
+    float weight, minSize, maxSize;
+    int32_t groupIndex, rowIndex;
+    uint32_t flags;                                 // NODE_LAYOUT_DIRTY
+};
+
+static_assert(sizeof(SnapshotHeader) % 8 == 0, "header must keep sections aligned");
+static_assert(sizeof(SnapshotNode) % 4 == 0, "node records must be 4-byte aligned");
+
+inline uint64_t Align8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+// 各段在文件中的偏移，由文件头的计数决定
+struct SnapshotLayout {
+    uint64_t strings, nodes, groupStart, groupMembers, rowStart, rowMembers, total;
+
+    explicit SnapshotLayout(const SnapshotHeader& header) {
+        strings = sizeof(SnapshotHeader);
+        nodes = Align8(strings + header.stringBytes);
+        groupStart = Align8(nodes + uint64_t(header.regionCount) * sizeof(SnapshotNode));
+        groupMembers = Align8(groupStart + (uint64_t(header.groupCount) + 1) * sizeof(int32_t));
+        rowStart = Align8(groupMembers + uint64_t(header.groupMemberCount) * sizeof(int32_t));
+        rowMembers = Align8(rowStart + (uint64_t(header.rowCount) + 1) * sizeof(int32_t));
+        total = Align8(rowMembers + uint64_t(header.rowMemberCount) * sizeof(int32_t));
+    }
+};
@@ -0,0 +1,111 @@
+// RegionSnapshotTest.cpp
+// 快照加载的校验测试：正常快照加载后各区域的字段与原树一致；
+// 篡改兄弟链表（成环、逆序）的快照被拒绝且加载在有限时间内返回。
+// 由ctest运行（见CMakeLists.txt，带超时，加载陷入死循环时判为失败）。
+//
+// 用法: RegionSnapshotTest [临时文件路径]
+
+#include "RegionSnapshot.h"
+#include "RegionSnapshotFormat.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+static void Check(bool condition, const char* what) {
+    std::printf("%s: %s\n", condition ? "ok  " : "FAIL", what);
+    if (!condition) failures++;
+}
+
+static std::vector<char> ReadFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static bool WriteFile(const std::string& path, const std::vector<char>& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(out);
+}
+
+static SnapshotHeader ReadHeader(const std::vector<char>& bytes) {
+    SnapshotHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    return header;
+}
+
+// 把区域region的nextSibling改为next
+static void PatchNextSibling(std::vector<char>& bytes, int region, int32_t next) {
+    const SnapshotLayout layout(ReadHeader(bytes));
+    const size_t offset = layout.nodes + region * sizeof(SnapshotNode) + offsetof(SnapshotNode, nextSibling);
+    std::memcpy(bytes.data() + offset, &next, sizeof(next));
+}
+
+// 根区域下一行两个叶子：0 -> 1 -> {2, 3}，各区域的矩形互不相同
+static RegionTree BuildTree() {
+    RegionTree tree;
+    const RegionHandle root = tree.AddRegion(INVALID_REGION, REGION_ROOT, "root", "Root");
+    const RegionHandle row = tree.AddRegion(root, REGION_ROW, "row", "Row");
+    tree.AddRegion(row, REGION_LEAF, "a", "A", "group1");
+    tree.AddRegion(row, REGION_LEAF, "b", "B", "group1");
+    for (size_t i = 0; i < tree.Size(); i++) {
+        tree.pos[i] = ImVec2(10.0f * i, 20.0f * i + 1.0f);
+        tree.size[i] = ImVec2(100.0f - i, 50.0f + i);
+    }
+    return tree;
+}
+
+static bool SameRegions(const RegionTree& a, const RegionTree& b) {
+    if (a.Size() != b.Size()) return false;
+    for (size_t i = 0; i < a.Size(); i++) {
+        if (a.id[i] != b.id[i] || a.name[i] != b.name[i] || a.groupId[i] != b.groupId[i] || a.type[i] != b.type[i] ||
+            a.parent[i] != b.parent[i] || a.firstChild[i] != b.firstChild[i] || a.lastChild[i] != b.lastChild[i] ||
+            a.nextSibling[i] != b.nextSibling[i] || a.childCount[i] != b.childCount[i] ||
+            a.pos[i].x != b.pos[i].x || a.pos[i].y != b.pos[i].y || a.size[i].x != b.size[i].x || a.size[i].y != b.size[i].y) {
+            std::printf("      region %zu differs\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const std::string path = argc > 1 ? argv[1] : "RegionSnapshotTest.bin";
+    std::string error;
+
+    const RegionTree source = BuildTree();
+    Check(WriteRegionSnapshot(path, source, &error), "write snapshot");
+    const std::vector<char> valid = ReadFile(path);
+    Check(valid.size() >= sizeof(SnapshotHeader) && valid.size() >= SnapshotLayout(ReadHeader(valid)).total, "snapshot size");
+    if (failures) return 1;
+
+    RegionTree loaded;
+    Check(LoadRegionSnapshot(path, loaded, &error), "load valid snapshot");
+    Check(SameRegions(source, loaded), "ids, names, links and rects round-trip");
+    Check(loaded.FindRegion("b") == 3 && loaded.FindRegion("row") == 1, "id index rebuilt");
+
+    // 兄弟链表成环：2 -> 3 -> 2
+    std::vector<char> cyclic = valid;
+    PatchNextSibling(cyclic, 3, 2);
+    Check(WriteFile(path, cyclic), "write cyclic snapshot");
+    error.clear();
+    Check(!LoadRegionSnapshot(path, loaded, &error) && loaded.Size() == 0, "reject sibling cycle");
+    std::printf("      %s\n", error.c_str());
+
+    // 兄弟指向自身
+    std::vector<char> selfLoop = valid;
+    PatchNextSibling(selfLoop, 2, 2);
+    Check(WriteFile(path, selfLoop), "write self-loop snapshot");
+    error.clear();
+    Check(!LoadRegionSnapshot(path, loaded, &error) && loaded.Size() == 0, "reject sibling self-loop");
+    std::printf("      %s\n", error.c_str());
+
+    std::remove(path.c_str());
+    return failures == 0 ? 0 : 1;
+}
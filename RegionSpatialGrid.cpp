@@ -0,0 +1,97 @@
+#include "RegionSpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+void RegionSpatialGrid::Clear() {
+    cols = rows = 0;
+    cellStart.clear();
+    cellItems.clear();
+}
+
+bool RegionSpatialGrid::CellOf(const ImVec2& point, int& col, int& row) const {
+    const float fx = (point.x - origin.x) / cellSize.x;
+    const float fy = (point.y - origin.y) / cellSize.y;
+    if (!(fx >= 0.0f && fy >= 0.0f)) return false; // 同时排除NaN
+    col = static_cast<int>(fx);
+    row = static_cast<int>(fy);
+    return col < cols && row < rows;
+}
+
+void RegionSpatialGrid::Build(const RegionTree& tree) {
+    Clear();
+    const RegionHandle root = tree.Root();
+    if (root == INVALID_REGION) return;
+
+    origin = tree.pos[root];
+    const ImVec2 bounds = tree.size[root];
+    if (bounds.x <= 0.0f || bounds.y <= 0.0f) return;
+
+    const size_t count = tree.Size();
+    size_t leafCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (tree.type[i] == REGION_LEAF) leafCount++;
+    }
+    if (leafCount == 0) return;
+
+    // 平均每个单元约2个叶子，单元尽量接近正方形
+    const float targetCells = std::max(1.0f, leafCount * 0.5f);
+    cols = std::clamp(static_cast<int>(std::ceil(std::sqrt(targetCells * bounds.x / bounds.y))), 1, 1024);
+    rows = std::clamp(static_cast<int>(std::ceil(targetCells / cols)), 1, 1024);
+    cellSize = ImVec2(bounds.x / cols, bounds.y / rows);
+
+    // 叶子覆盖的单元范围
+    auto cellRange = [&](size_t i, int& c0, int& r0, int& c1, int& r1) {
+        const ImVec2 pos = tree.pos[i];
+        const ImVec2 size = tree.size[i];
+        c0 = std::clamp(static_cast<int>((pos.x - origin.x) / cellSize.x), 0, cols - 1);
+        r0 = std::clamp(static_cast<int>((pos.y - origin.y) / cellSize.y), 0, rows - 1);
+        c1 = std::clamp(static_cast<int>((pos.x + size.x - origin.x) / cellSize.x), 0, cols - 1);
+        r1 = std::clamp(static_cast<int>((pos.y + size.y - origin.y) / cellSize.y), 0, rows - 1);
+    };
+
+    // 两遍计数生成单元表
+    cellStart.assign(static_cast<size_t>(cols) * rows + 1, 0);
+    for (size_t i = 0; i < count; i++) {
+        if (tree.type[i] != REGION_LEAF || tree.size[i].x <= 0.0f || tree.size[i].y <= 0.0f) continue;
+        int c0, r0, c1, r1;
+        cellRange(i, c0, r0, c1, r1);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                cellStart[r * cols + c + 1]++;
+            }
+        }
+    }
+    for (size_t i = 1; i < cellStart.size(); i++) {
+        cellStart[i] += cellStart[i - 1];
+    }
+
+    cellItems.resize(cellStart.back());
+    std::vector<int> cursor(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        if (tree.type[i] != REGION_LEAF || tree.size[i].x <= 0.0f || tree.size[i].y <= 0.0f) continue;
+        int c0, r0, c1, r1;
+        cellRange(i, c0, r0, c1, r1);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                cellItems[cursor[r * cols + c]++] = static_cast<RegionHandle>(i);
+            }
+        }
+    }
+}
+
+RegionHandle RegionSpatialGrid::HitTest(const RegionTree& tree, const ImVec2& point) const {
+    int col, row;
+    if (cols == 0 || !CellOf(point, col, row)) return INVALID_REGION;
+
+    const int cell = row * cols + col;
+    for (int i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+        const RegionHandle region = cellItems[i];
+        const ImVec2 pos = tree.pos[region];
+        const ImVec2 size = tree.size[region];
+        if (point.x >= pos.x && point.x < pos.x + size.x &&
+            point.y >= pos.y && point.y < pos.y + size.y) {
+            return region;
+        }
+    }
+    return INVALID_REGION;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+#include "RegionTree.h"
+
+// 叶子区域的均匀网格索引，用于鼠标命中检测
+// 只在布局变化时重建，命中检测只查一个网格单元
+class RegionSpatialGrid {
+public:
+    void Build(const RegionTree& tree);
+    void Clear();
+
+    // 返回包含point的叶子区域，没有则返回INVALID_REGION
+    RegionHandle HitTest(const RegionTree& tree, const ImVec2& point) const;
+
+private:
+    bool CellOf(const ImVec2& point, int& col, int& row) const;
+
+    ImVec2 origin;                      // 网格左上角（根区域位置）
+    ImVec2 cellSize;                    // 单元大小
+    int cols = 0;
+    int rows = 0;
+    std::vector<int> cellStart;         // 第i个单元的叶子为[cellStart[i], cellStart[i+1])
+    std::vector<RegionHandle> cellItems;
+};
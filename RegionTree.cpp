@@ -0,0 +1,281 @@
+#include "RegionTree.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+
+std::string_view RegionStringPool::Intern(std::string_view str) {
+    // 多留一个字节存放'\0'，方便直接传给ImGui
+    const size_t needed = str.size() + 1;
+    if (needed > CHUNK_SIZE) {
+        // 超大字符串单独分配，插在当前块之前，不影响当前块的写入位置
+        auto where = chunks.empty() ? chunks.end() : chunks.end() - 1;
+        char* dst = chunks.emplace(where, new char[needed])->get();
+        if (!str.empty()) memcpy(dst, str.data(), str.size());
+        dst[str.size()] = '\0';
+        return std::string_view(dst, str.size());
+    }
+    if (chunkUsed + needed > CHUNK_SIZE) {
+        chunks.emplace_back(new char[CHUNK_SIZE]);
+        chunkUsed = 0;
+    }
+    char* dst = chunks.back().get() + chunkUsed;
+    if (!str.empty()) memcpy(dst, str.data(), str.size()); // 空的string_view的data()可能为nullptr
+    dst[str.size()] = '\0';
+    chunkUsed += needed;
+    return std::string_view(dst, str.size());
+}
+
+void RegionStringPool::Retain(std::shared_ptr<const void> storage) {
+    external.push_back(std::move(storage));
+}
+
+void RegionStringPool::Clear() {
+    chunks.clear();
+    chunkUsed = CHUNK_SIZE;
+    external.clear();
+}
+
+void RegionIdIndex::Grow() {
+    std::vector<Slot> oldSlots;
+    oldSlots.swap(slots);
+    slots.resize(oldSlots.empty() ? 64 : oldSlots.size() * 2);
+    const size_t mask = slots.size() - 1;
+    for (const Slot& slot : oldSlots) {
+        if (slot.handle == INVALID_REGION) continue;
+        size_t i = slot.hash & mask;
+        while (slots[i].handle != INVALID_REGION) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+    }
+}
+
+void RegionIdIndex::Reserve(size_t count) {
+    // 插入count个后负载因子仍不超过0.5
+    while (count * 2 > slots.size()) {
+        Grow();
+    }
+}
+
+void RegionIdIndex::Insert(std::string_view id, RegionHandle handle) {
+    // 负载因子保持在0.5以下
+    if ((count + 1) * 2 > slots.size()) {
+        Grow();
+    }
+    const size_t mask = slots.size() - 1;
+    const size_t hash = std::hash<std::string_view>()(id);
+    size_t i = hash & mask;
+    while (slots[i].handle != INVALID_REGION) {
+        i = (i + 1) & mask;
+    }
+    slots[i].hash = hash;
+    slots[i].handle = handle;
+    count++;
+}
+
+RegionHandle RegionIdIndex::Find(std::string_view id, const std::vector<std::string_view>& ids) const {
+    if (slots.empty()) return INVALID_REGION;
+    const size_t mask = slots.size() - 1;
+    const size_t hash = std::hash<std::string_view>()(id);
+    for (size_t i = hash & mask; slots[i].handle != INVALID_REGION; i = (i + 1) & mask) {
+        if (slots[i].hash == hash && ids[slots[i].handle] == id) {
+            return slots[i].handle;
+        }
+    }
+    return INVALID_REGION;
+}
+
+void RegionIdIndex::Clear() {
+    slots.clear();
+    count = 0;
+}
+
+RegionHandle RegionTree::AddRegion(RegionHandle parentHandle, RegionType regionType,
+    std::string_view regionId, std::string_view regionName, std::string_view regionGroupId) {
+    const RegionHandle handle = static_cast<RegionHandle>(type.size());
+
+    id.push_back(strings.Intern(regionId));
+    name.push_back(strings.Intern(regionName));
+    groupId.push_back(strings.Intern(regionGroupId));
+    type.push_back(regionType);
+    pos.emplace_back();
+    size.emplace_back();
+    state.emplace_back();
+    parent.push_back(parentHandle);
+    firstChild.push_back(INVALID_REGION);
+    lastChild.push_back(INVALID_REGION);
+    nextSibling.push_back(INVALID_REGION);
+    childCount.push_back(0);
+    constraint.emplace_back();
+    layoutDirty.push_back(1);
+
+    // 挂到父区域的子链表末尾
+    if (parentHandle != INVALID_REGION) {
+        if (lastChild[parentHandle] == INVALID_REGION) {
+            firstChild[parentHandle] = handle;
+        }
+        else {
+            nextSibling[lastChild[parentHandle]] = handle;
+        }
+        lastChild[parentHandle] = handle;
+        childCount[parentHandle]++;
+        MarkLayoutDirty(parentHandle);
+    }
+
+    idIndex.Insert(id[handle], handle);
+    membershipDirty = true;
+    layoutVersion++;
+    return handle;
+}
+
+void RegionTree::Clear() {
+    id.clear();
+    name.clear();
+    groupId.clear();
+    type.clear();
+    pos.clear();
+    size.clear();
+    state.clear();
+    parent.clear();
+    firstChild.clear();
+    lastChild.clear();
+    nextSibling.clear();
+    childCount.clear();
+    constraint.clear();
+    layoutDirty.clear();
+    groupIndex.clear();
+    rowIndex.clear();
+    groupMembers.clear();
+    groupMemberStart.clear();
+    rowMembers.clear();
+    rowMemberStart.clear();
+    strings.Clear();
+    idIndex.Clear();
+    membershipDirty = true;
+    layoutVersion++;
+}
+
+void RegionTree::Reserve(size_t count) {
+    id.reserve(count);
+    name.reserve(count);
+    groupId.reserve(count);
+    type.reserve(count);
+    pos.reserve(count);
+    size.reserve(count);
+    state.reserve(count);
+    parent.reserve(count);
+    firstChild.reserve(count);
+    lastChild.reserve(count);
+    nextSibling.reserve(count);
+    childCount.reserve(count);
+    constraint.reserve(count);
+    layoutDirty.reserve(count);
+}
+
+void RegionTree::Resize(size_t count) {
+    id.resize(count);
+    name.resize(count);
+    groupId.resize(count);
+    type.resize(count);
+    pos.resize(count);
+    size.resize(count);
+    state.resize(count);
+    parent.resize(count);
+    firstChild.resize(count);
+    lastChild.resize(count);
+    nextSibling.resize(count);
+    childCount.resize(count);
+    constraint.resize(count);
+    layoutDirty.resize(count);
+}
+
+void RegionTree::FinishBulkLoad(std::shared_ptr<const void> storage, bool hasMembership) {
+    if (storage) strings.Retain(std::move(storage));
+    idIndex.Clear();
+    idIndex.Reserve(Size());
+    for (size_t i = 0; i < Size(); i++) {
+        idIndex.Insert(id[i], static_cast<RegionHandle>(i));
+    }
+    membershipDirty = !hasMembership;
+    layoutVersion++;
+}
+
+void RegionTree::MarkLayoutDirty(RegionHandle region) {
+    // 布局程序顺序检查每个区域的标记，不需要向祖先传播
+    layoutDirty[region] = 1;
+}
+
+void RegionTree::SetConstraint(RegionHandle region, const RegionConstraint& value) {
+    constraint[region] = value;
+    constraint[region].weight = std::max(0.0f, value.weight);
+    constraint[region].minSize = std::max(0.0f, value.minSize);
+    constraint[region].maxSize = std::max(constraint[region].minSize, value.maxSize);
+    if (parent[region] != INVALID_REGION) MarkLayoutDirty(parent[region]);
+    layoutVersion++;
+}
+
+void RegionTree::BuildMembership() {
+    const size_t count = Size();
+    groupIndex.assign(count, -1);
+    rowIndex.assign(count, -1);
+
+    // 组ID和行编号为整数
+    std::unordered_map<std::string_view, int> groupNumbers;
+    int rowCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!groupId[i].empty()) {
+            auto it = groupNumbers.emplace(groupId[i], static_cast<int>(groupNumbers.size())).first;
+            groupIndex[i] = it->second;
+        }
+        if (type[i] == REGION_ROW) {
+            rowIndex[i] = rowCount++;
+        }
+    }
+    // 行的直接叶子使用所在行的编号（父区域总是先于子区域创建）
+    for (size_t i = 0; i < count; i++) {
+        const RegionHandle p = parent[i];
+        if (type[i] == REGION_LEAF && p != INVALID_REGION && type[p] == REGION_ROW) {
+            rowIndex[i] = rowIndex[p];
+        }
+    }
+
+    // 计数排序生成成员表
+    const int groupCount = static_cast<int>(groupNumbers.size());
+    groupMemberStart.assign(groupCount + 1, 0);
+    rowMemberStart.assign(rowCount + 1, 0);
+    for (size_t i = 0; i < count; i++) {
+        if (type[i] != REGION_LEAF) continue;
+        if (groupIndex[i] >= 0) groupMemberStart[groupIndex[i] + 1]++;
+        if (rowIndex[i] >= 0) rowMemberStart[rowIndex[i] + 1]++;
+    }
+    for (int k = 0; k < groupCount; k++) groupMemberStart[k + 1] += groupMemberStart[k];
+    for (int k = 0; k < rowCount; k++) rowMemberStart[k + 1] += rowMemberStart[k];
+
+    groupMembers.resize(groupMemberStart[groupCount]);
+    rowMembers.resize(rowMemberStart[rowCount]);
+    std::vector<int> groupCursor(groupMemberStart.begin(), groupMemberStart.end() - 1);
+    std::vector<int> rowCursor(rowMemberStart.begin(), rowMemberStart.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        if (type[i] != REGION_LEAF) continue;
+        const RegionHandle handle = static_cast<RegionHandle>(i);
+        if (groupIndex[i] >= 0) groupMembers[groupCursor[groupIndex[i]]++] = handle;
+        if (rowIndex[i] >= 0) rowMembers[rowCursor[rowIndex[i]]++] = handle;
+    }
+
+    membershipDirty = false;
+}
+
+RegionHandle RegionTree::FindRegion(std::string_view targetId) const {
+    return idIndex.Find(targetId, id);
+}
+
+std::string_view IDGenerator::GetID(std::string_view prefix) {
+    char digits[16];
+    const char* digitsEnd = std::to_chars(digits, digits + sizeof(digits), counter++).ptr;
+    buffer.assign(prefix);
+    buffer += "##";
+    buffer.append(digits, static_cast<size_t>(digitsEnd - digits));
+    return buffer;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <vector>
+#include <cfloat>
+#include <string>
+#include <string_view>
+#include <memory>
+#include "imgui.h"
+
+// 区域类型
+enum RegionType {
+    REGION_ROOT,    // 根区域
+    REGION_ROW,     // 行区域
+    REGION_GROUP,   // 组区域
+    REGION_LEAF     // 叶子区域
+};
+
+// 区域状态（焦点状态单独存放在RegionFocusSet位集中）
+struct RegionState {
+    bool isHovered = false;
+};
+
+// 布局约束，尺寸沿父区域的分割方向（行/组的子区域为宽度，根区域下的行为高度）
+struct RegionConstraint {
+    float weight = 1.0f;      // 分配父区域空间的权重
+    float minSize = 0.0f;     // 最小尺寸
+    float maxSize = FLT_MAX;  // 最大尺寸
+};
+
+// 区域句柄（区域存储中的下标，构建后保持稳定）
+using RegionHandle = int;
+constexpr RegionHandle INVALID_REGION = -1;
+
+// 字符串池：区域的id/名称/组ID统一存放在分块内存中
+// 也可以持有外部内存（如映射的快照文件），字符串直接引用其中的内容
+class RegionStringPool {
+private:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+    std::vector<std::unique_ptr<char[]>> chunks;
+    size_t chunkUsed = CHUNK_SIZE;
+    std::vector<std::shared_ptr<const void>> external;
+
+public:
+    std::string_view Intern(std::string_view str);
+    void Retain(std::shared_ptr<const void> storage); // 保持外部内存有效直到Clear
+    void Clear();
+};
+
+// id -> 句柄 哈希索引（开放寻址，线性探测）
+class RegionIdIndex {
+private:
+    struct Slot {
+        size_t hash = 0;
+        RegionHandle handle = INVALID_REGION;
+    };
+    std::vector<Slot> slots;
+    size_t count = 0;
+
+    void Grow();
+
+public:
+    void Reserve(size_t count);
+    void Insert(std::string_view id, RegionHandle handle);
+    RegionHandle Find(std::string_view id, const std::vector<std::string_view>& ids) const;
+    void Clear();
+};
+
+// 区域树：扁平的SoA数组，父子关系用句柄表示
+class RegionTree {
+public:
+    // 以下数组按句柄下标访问，结构修改请使用成员函数
+    std::vector<std::string_view> id;       // 唯一标识符
+    std::vector<std::string_view> name;     // 区域名称
+    std::vector<std::string_view> groupId;  // 所属组ID
+    std::vector<RegionType> type;           // 区域类型
+    std::vector<ImVec2> pos;                // 位置
+    std::vector<ImVec2> size;               // 大小
+    std::vector<RegionState> state;         // 状态
+    std::vector<RegionHandle> parent;       // 父区域
+    std::vector<RegionHandle> firstChild;   // 第一个子区域
+    std::vector<RegionHandle> lastChild;    // 最后一个子区域
+    std::vector<RegionHandle> nextSibling;  // 下一个兄弟区域
+    std::vector<int> childCount;            // 子区域数量
+    std::vector<RegionConstraint> constraint; // 布局约束
+    std::vector<unsigned char> layoutDirty; // 布局脏标记：子区域需要重新分割
+
+    // 组/行成员索引（BuildMembership构建，组ID和行均编号为整数）
+    std::vector<int> groupIndex;            // 组编号，-1表示无组
+    std::vector<int> rowIndex;              // 所在行编号，仅行的直接叶子有效，-1表示无
+    std::vector<RegionHandle> groupMembers; // 各组的叶子，第k组为[groupMemberStart[k], groupMemberStart[k+1])
+    std::vector<int> groupMemberStart;
+    std::vector<RegionHandle> rowMembers;   // 各行的直接叶子，第k行为[rowMemberStart[k], rowMemberStart[k+1])
+    std::vector<int> rowMemberStart;
+
+    // 添加区域，parent为INVALID_REGION时作为根区域
+    RegionHandle AddRegion(RegionHandle parentHandle, RegionType regionType,
+        std::string_view regionId, std::string_view regionName,
+        std::string_view regionGroupId = {});
+
+    void Clear();
+    void Reserve(size_t count);
+
+    // 批量加载（如从快照）：Clear后Resize，调用方直接填充各数组，最后调用FinishBulkLoad重建id索引
+    // storage为字符串引用的外部内存，hasMembership表示成员索引数组也已填好
+    void Resize(size_t count);
+    void FinishBulkLoad(std::shared_ptr<const void> storage, bool hasMembership);
+
+    // 标记区域的子区域需要重新分割
+    void MarkLayoutDirty(RegionHandle region);
+
+    // 设置布局约束（父区域重新分割；布局程序需要重新编译）
+    void SetConstraint(RegionHandle region, const RegionConstraint& value);
+    // 布局版本：结构或约束变化时递增
+    unsigned int GetLayoutVersion() const { return layoutVersion; }
+
+    // 构建组/行成员索引，树构建完成后调用（结构变化后会自动重建）
+    void BuildMembership();
+    bool HasMembership() const { return !membershipDirty; }
+
+    size_t Size() const { return type.size(); }
+    RegionHandle Root() const { return type.empty() ? INVALID_REGION : 0; }
+    bool IsLeaf(RegionHandle region) const { return type[region] == REGION_LEAF; }
+
+    // 查找区域（O(1)哈希查找）
+    RegionHandle FindRegion(std::string_view targetId) const;
+
+private:
+    RegionStringPool strings;
+    RegionIdIndex idIndex;
+    bool membershipDirty = true;
+    unsigned int layoutVersion = 0;
+};
+
+// 唯一ID生成器：生成"前缀##序号"，写入复用的缓冲区，结果在下次调用前有效
+// （AddRegion立即把它复制到字符串池，构建大树时不再为每个ID分配临时字符串）
+class IDGenerator {
+private:
+    int counter = 0;
+    std::string buffer;
+public:
+    std::string_view GetID(std::string_view prefix);
+};
@@ -0,0 +1,472 @@
+#include "SoftwareRenderer.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_RENDERER_SSE2 1
+#endif
+
+namespace {
+
+constexpr int BAND_HEIGHT = 32; // 每个并行任务处理的行数
+
+struct Texture {
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> texels;
+};
+
+// x / 255 四舍五入，x <= 65025时结果精确（SIMD路径使用同一公式，保证结果一致）
+inline uint32_t Div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// 颜色相乘（顶点颜色 * 纹素）
+inline uint32_t Modulate(uint32_t a, uint32_t b) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        result |= Div255(((a >> shift) & 0xFF) * ((b >> shift) & 0xFF)) << shift;
+    }
+    return result;
+}
+
+// 源像素按其透明度混合到目标像素上
+inline uint32_t BlendPixel(uint32_t dst, uint32_t src) {
+    const uint32_t alpha = src >> 24;
+    const uint32_t inverse = 255 - alpha;
+    uint32_t result = 0;
+    for (int shift = 0; shift < 24; shift += 8) {
+        result |= Div255(((src >> shift) & 0xFF) * alpha + ((dst >> shift) & 0xFF) * inverse) << shift;
+    }
+    result |= Div255(255 * alpha + (dst >> 24) * inverse) << 24;
+    return result;
+}
+
+// 同一颜色填充一段像素
+void FillSpan(uint32_t* dst, int count, uint32_t src) {
+    const uint32_t alpha = src >> 24;
+    if (alpha == 0) return;
+    if (alpha == 255) {
+        std::fill(dst, dst + count, src);
+        return;
+    }
+    int i = 0;
+#ifdef SOFTWARE_RENDERER_SSE2
+    // 每次混合4个像素：8个16位通道，srcTerm = src * alpha（透明度通道的src按255计算）
+    const uint32_t srcOpaque = src | 0xFF000000u;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i srcTerm = _mm_mullo_epi16(
+        _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(srcOpaque)), zero),
+        _mm_set1_epi16(static_cast<short>(alpha)));
+    const __m128i inverse = _mm_set1_epi16(static_cast<short>(255 - alpha));
+    const __m128i bias = _mm_set1_epi16(128);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i lo = _mm_add_epi16(_mm_add_epi16(srcTerm, _mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), inverse)), bias);
+        __m128i hi = _mm_add_epi16(_mm_add_epi16(srcTerm, _mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), inverse)), bias);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = BlendPixel(dst[i], src);
+    }
+}
+
+uint32_t SampleTexture(const Texture* texture, float u, float v) {
+    if (!texture) return 0xFFFFFFFFu;
+    const int x = std::clamp(static_cast<int>(std::floor(u * texture->width)), 0, texture->width - 1);
+    const int y = std::clamp(static_cast<int>(std::floor(v * texture->height)), 0, texture->height - 1);
+    return texture->texels[static_cast<size_t>(y) * texture->width + x];
+}
+
+// 裁剪区域（像素，右下为开区间）
+struct PixelRect {
+    int x0, y0, x1, y1;
+};
+
+struct RasterVertex {
+    float x, y, u, v;
+    uint32_t col;
+};
+
+// 三角形的一条边，端点按(y, x)排序。共享边的两个三角形计算出完全相同的交点，
+// 配合行、列的半开区间规则，相邻三角形之间不重叠也不留缝
+struct Edge {
+    float x0, y0, y1, dxdy;
+
+    Edge(const RasterVertex& a, const RasterVertex& b) {
+        const bool swap = (b.y < a.y) || (b.y == a.y && b.x < a.x);
+        const RasterVertex& p = swap ? b : a;
+        const RasterVertex& q = swap ? a : b;
+        x0 = p.x;
+        y0 = p.y;
+        y1 = q.y;
+        dxdy = (q.y != p.y) ? (q.x - p.x) / (q.y - p.y) : 0.0f;
+    }
+
+    bool Crosses(float y) const { return y0 <= y && y < y1; }
+    float XAt(float y) const { return x0 + (y - y0) * dxdy; }
+};
+
+// 属性平面 f(x, y) = a * x + b * y + c
+struct Plane {
+    float a, b, c;
+
+    Plane(const RasterVertex* v, float f0, float f1, float f2, float invDet) {
+        const float dx1 = v[1].x - v[0].x, dy1 = v[1].y - v[0].y;
+        const float dx2 = v[2].x - v[0].x, dy2 = v[2].y - v[0].y;
+        a = ((f1 - f0) * dy2 - (f2 - f0) * dy1) * invDet;
+        b = ((f2 - f0) * dx1 - (f1 - f0) * dx2) * invDet;
+        c = f0 - a * v[0].x - b * v[0].y;
+    }
+
+    float At(float x, float y) const { return a * x + b * y + c; }
+};
+
+inline float Channel(uint32_t col, int shift) {
+    return static_cast<float>((col >> shift) & 0xFF);
+}
+
+inline uint32_t ToByte(float value) {
+    return static_cast<uint32_t>(std::clamp(value + 0.5f, 0.0f, 255.0f));
+}
+
+void RasterizeTriangle(const RasterVertex* v, const Texture* texture, const PixelRect& clip, SoftwareImage& target) {
+    const float minY = std::min({ v[0].y, v[1].y, v[2].y });
+    const float maxY = std::max({ v[0].y, v[1].y, v[2].y });
+    const float minX = std::min({ v[0].x, v[1].x, v[2].x });
+    const float maxX = std::max({ v[0].x, v[1].x, v[2].x });
+
+    // 像素中心(x + 0.5, y + 0.5)落在三角形内才绘制
+    const int rowBegin = std::max(clip.y0, static_cast<int>(std::ceil(minY - 0.5f)));
+    const int rowEnd = std::min(clip.y1, static_cast<int>(std::ceil(maxY - 0.5f)));
+    const int colBegin = std::max(clip.x0, static_cast<int>(std::ceil(minX - 0.5f)));
+    const int colEnd = std::min(clip.x1, static_cast<int>(std::ceil(maxX - 0.5f)));
+    if (rowBegin >= rowEnd || colBegin >= colEnd) return;
+
+    const float det = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+    if (det == 0.0f) return;
+
+    const Edge edges[3] = { Edge(v[0], v[1]), Edge(v[1], v[2]), Edge(v[2], v[0]) };
+
+    // 颜色和UV都不变时（纯色矩形、背景等，占绝大多数像素）整段用同一颜色填充
+    const bool constantColor = v[0].col == v[1].col && v[1].col == v[2].col;
+    const bool constantUV = v[0].u == v[1].u && v[1].u == v[2].u && v[0].v == v[1].v && v[1].v == v[2].v;
+    const bool constant = constantColor && constantUV;
+    const uint32_t constantSrc = constant ? Modulate(v[0].col, SampleTexture(texture, v[0].u, v[0].v)) : 0;
+
+    const float invDet = 1.0f / det;
+    const Plane planeU(v, v[0].u, v[1].u, v[2].u, invDet);
+    const Plane planeV(v, v[0].v, v[1].v, v[2].v, invDet);
+    const Plane planeColor[4] = {
+        Plane(v, Channel(v[0].col, 0), Channel(v[1].col, 0), Channel(v[2].col, 0), invDet),
+        Plane(v, Channel(v[0].col, 8), Channel(v[1].col, 8), Channel(v[2].col, 8), invDet),
+        Plane(v, Channel(v[0].col, 16), Channel(v[1].col, 16), Channel(v[2].col, 16), invDet),
+        Plane(v, Channel(v[0].col, 24), Channel(v[1].col, 24), Channel(v[2].col, 24), invDet),
+    };
+
+    for (int y = rowBegin; y < rowEnd; y++) {
+        const float centerY = y + 0.5f;
+        float crossings[2];
+        int crossingCount = 0;
+        for (const Edge& edge : edges) {
+            if (crossingCount < 2 && edge.Crosses(centerY)) {
+                crossings[crossingCount++] = edge.XAt(centerY);
+            }
+        }
+        if (crossingCount < 2) continue;
+
+        const float left = std::min(crossings[0], crossings[1]);
+        const float right = std::max(crossings[0], crossings[1]);
+        const int x0 = std::max(colBegin, static_cast<int>(std::ceil(left - 0.5f)));
+        const int x1 = std::min(colEnd, static_cast<int>(std::ceil(right - 0.5f)));
+        if (x0 >= x1) continue;
+
+        uint32_t* row = target.pixels.data() + static_cast<size_t>(y) * target.width;
+        if (constant) {
+            FillSpan(row + x0, x1 - x0, constantSrc);
+            continue;
+        }
+
+        for (int x = x0; x < x1; x++) {
+            const float centerX = x + 0.5f;
+            const uint32_t color = constantColor ? v[0].col :
+                ToByte(planeColor[0].At(centerX, centerY)) |
+                (ToByte(planeColor[1].At(centerX, centerY)) << 8) |
+                (ToByte(planeColor[2].At(centerX, centerY)) << 16) |
+                (ToByte(planeColor[3].At(centerX, centerY)) << 24);
+            const uint32_t texel = constantUV ? SampleTexture(texture, v[0].u, v[0].v) :
+                SampleTexture(texture, planeU.At(centerX, centerY), planeV.At(centerX, centerY));
+            const uint32_t src = Modulate(color, texel);
+            if ((src >> 24) != 0) {
+                row[x] = BlendPixel(row[x], src);
+            }
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////// PNG
+uint32_t Crc32(uint32_t crc, const unsigned char* data, size_t size) {
+    static uint32_t table[256];
+    static const bool initialized = [] {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return true;
+    }();
+    (void)initialized;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void PutBigEndian(std::vector<unsigned char>& out, uint32_t value) {
+    out.push_back(static_cast<unsigned char>(value >> 24));
+    out.push_back(static_cast<unsigned char>(value >> 16));
+    out.push_back(static_cast<unsigned char>(value >> 8));
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+void PutChunk(std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data) {
+    PutBigEndian(out, static_cast<uint32_t>(data.size()));
+    const size_t typeOffset = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    PutBigEndian(out, Crc32(0, out.data() + typeOffset, out.size() - typeOffset));
+}
+
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////// SoftwareImage
+void SoftwareImage::Resize(int newWidth, int newHeight) {
+    width = std::max(0, newWidth);
+    height = std::max(0, newHeight);
+    pixels.assign(static_cast<size_t>(width) * height, 0);
+}
+
+void SoftwareImage::Clear(ImU32 color) {
+    std::fill(pixels.begin(), pixels.end(), color);
+}
+
+///////////////////////////////////////////////////////////////////////////// SoftwareRenderer
+struct SoftwareRenderer::Impl {
+    std::vector<std::unique_ptr<Texture>> textures;
+
+    // 工作线程：每次Render发布一个任务（generation加1），各线程抢条带直到取完
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    unsigned long long generation = 0;
+    int busyWorkers = 0;
+    bool stopping = false;
+
+    // 当前任务
+    const ImDrawData* drawData = nullptr;
+    SoftwareImage* target = nullptr;
+    int bandCount = 0;
+    std::atomic<int> nextBand{ 0 };
+
+    const Texture* FindTexture(ImTextureID id) const {
+        for (const auto& texture : textures) {
+            if (reinterpret_cast<ImTextureID>(texture.get()) == id) return texture.get();
+        }
+        return nullptr;
+    }
+
+    void RunBands() {
+        for (int band = nextBand.fetch_add(1); band < bandCount; band = nextBand.fetch_add(1)) {
+            const int y0 = band * BAND_HEIGHT;
+            RenderBand(y0, std::min(target->height, y0 + BAND_HEIGHT));
+        }
+    }
+
+    void WorkerMain() {
+        unsigned long long seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            RunBands();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--busyWorkers == 0) done.notify_one();
+            }
+        }
+    }
+
+    void RenderBand(int bandY0, int bandY1);
+};
+
+void SoftwareRenderer::Impl::RenderBand(int bandY0, int bandY1) {
+    const ImVec2 clipOffset = drawData->DisplayPos;
+    const ImVec2 clipScale = drawData->FramebufferScale;
+    RasterVertex triangle[3];
+
+    for (int n = 0; n < drawData->CmdListsCount; n++) {
+        const ImDrawList* drawList = drawData->CmdLists[n];
+        const ImDrawVert* vertices = drawList->VtxBuffer.Data;
+        const ImDrawIdx* indices = drawList->IdxBuffer.Data;
+
+        for (int c = 0; c < drawList->CmdBuffer.Size; c++) {
+            const ImDrawCmd& cmd = drawList->CmdBuffer[c];
+            if (cmd.UserCallback) continue;
+
+            // 与OpenGL后端相同的裁剪矩形换算，再限制到本条带
+            PixelRect clip;
+            clip.x0 = std::max(0, static_cast<int>((cmd.ClipRect.x - clipOffset.x) * clipScale.x));
+            clip.y0 = std::max(bandY0, static_cast<int>((cmd.ClipRect.y - clipOffset.y) * clipScale.y));
+            clip.x1 = std::min(target->width, static_cast<int>((cmd.ClipRect.z - clipOffset.x) * clipScale.x));
+            clip.y1 = std::min(bandY1, static_cast<int>((cmd.ClipRect.w - clipOffset.y) * clipScale.y));
+            if (clip.x0 >= clip.x1 || clip.y0 >= clip.y1) continue;
+
+            const Texture* texture = FindTexture(cmd.GetTexID());
+            const ImDrawIdx* idx = indices + cmd.IdxOffset;
+            const ImDrawVert* vtx = vertices + cmd.VtxOffset;
+            for (unsigned int i = 0; i + 2 < cmd.ElemCount; i += 3) {
+                for (int k = 0; k < 3; k++) {
+                    const ImDrawVert& src = vtx[idx[i + k]];
+                    triangle[k] = {
+                        (src.pos.x - clipOffset.x) * clipScale.x,
+                        (src.pos.y - clipOffset.y) * clipScale.y,
+                        src.uv.x, src.uv.y, src.col
+                    };
+                }
+                RasterizeTriangle(triangle, texture, clip, *target);
+            }
+        }
+    }
+}
+
+SoftwareRenderer::SoftwareRenderer(int threadCount)
+    : impl(std::make_unique<Impl>()) {
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    // 调用Render的线程也参与光栅化
+    for (int i = 1; i < threadCount; i++) {
+        impl->workers.emplace_back([this] { impl->WorkerMain(); });
+    }
+}
+
+SoftwareRenderer::~SoftwareRenderer() {
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->stopping = true;
+    }
+    impl->wake.notify_all();
+    for (auto& worker : impl->workers) {
+        worker.join();
+    }
+}
+
+ImTextureID SoftwareRenderer::CreateTexture(const unsigned char* rgba, int width, int height) {
+    auto texture = std::make_unique<Texture>();
+    texture->width = width;
+    texture->height = height;
+    texture->texels.resize(static_cast<size_t>(width) * height);
+    std::memcpy(texture->texels.data(), rgba, texture->texels.size() * sizeof(uint32_t));
+    impl->textures.push_back(std::move(texture));
+    return reinterpret_cast<ImTextureID>(impl->textures.back().get());
+}
+
+void SoftwareRenderer::CreateFontsTexture() {
+    ImGuiIO& io = ImGui::GetIO();
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    io.Fonts->SetTexID(CreateTexture(pixels, width, height));
+}
+
+void SoftwareRenderer::Render(const ImDrawData* drawData, SoftwareImage& target) {
+    if (!drawData || drawData->CmdListsCount == 0 || target.width <= 0 || target.height <= 0) {
+        return;
+    }
+
+    impl->drawData = drawData;
+    impl->target = &target;
+    impl->bandCount = (target.height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+    impl->nextBand.store(0);
+
+    if (!impl->workers.empty()) {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->busyWorkers = static_cast<int>(impl->workers.size());
+        impl->generation++;
+    }
+    impl->wake.notify_all();
+
+    impl->RunBands();
+
+    std::unique_lock<std::mutex> lock(impl->mutex);
+    impl->done.wait(lock, [&] { return impl->busyWorkers == 0; });
+    impl->drawData = nullptr;
+    impl->target = nullptr;
+}
+
+int SoftwareRenderer::GetThreadCount() const {
+    return static_cast<int>(impl->workers.size()) + 1;
+}
+
+bool SoftwareRenderer::WritePNG(const std::string& path, const SoftwareImage& image) {
+    if (image.width <= 0 || image.height <= 0) return false;
+
+    // 每行前加过滤类型0
+    const size_t rowBytes = static_cast<size_t>(image.width) * 4 + 1;
+    std::vector<unsigned char> raw(rowBytes * image.height);
+    for (int y = 0; y < image.height; y++) {
+        unsigned char* row = raw.data() + rowBytes * y;
+        row[0] = 0;
+        std::memcpy(row + 1, image.pixels.data() + static_cast<size_t>(y) * image.width, rowBytes - 1);
+    }
+
+    // zlib流，只用不压缩的存储块（每块最多65535字节）
+    std::vector<unsigned char> zlib = { 0x78, 0x01 };
+    uint32_t adlerA = 1, adlerB = 0;
+    for (size_t offset = 0; offset < raw.size();) {
+        const size_t blockSize = std::min<size_t>(65535, raw.size() - offset);
+        const bool last = offset + blockSize == raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(static_cast<unsigned char>(blockSize));
+        zlib.push_back(static_cast<unsigned char>(blockSize >> 8));
+        zlib.push_back(static_cast<unsigned char>(~blockSize));
+        zlib.push_back(static_cast<unsigned char>(~blockSize >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+        for (size_t i = offset; i < offset + blockSize; i++) {
+            adlerA = (adlerA + raw[i]) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+        offset += blockSize;
+    }
+    PutBigEndian(zlib, (adlerB << 16) | adlerA);
+
+    std::vector<unsigned char> header;
+    PutBigEndian(header, static_cast<uint32_t>(image.width));
+    PutBigEndian(header, static_cast<uint32_t>(image.height));
+    header.insert(header.end(), { 8, 6, 0, 0, 0 }); // 8位RGBA，不隔行
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::vector<unsigned char> png(signature, signature + 8);
+    PutChunk(png, "IHDR", header);
+    PutChunk(png, "IDAT", zlib);
+    PutChunk(png, "IEND", {});
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    const bool ok = std::fwrite(png.data(), 1, png.size(), file) == png.size();
+    return std::fclose(file) == 0 && ok;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <imgui.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// CPU渲染后端：把ImDrawData光栅化到内存中的RGBA图像，不需要窗口和GPU
+//
+// 支持纹理三角形（最近点采样）、裁剪矩形和顶点颜色，混合方式与OpenGL后端相同
+// （颜色 SRC_ALPHA / ONE_MINUS_SRC_ALPHA，透明度 ONE / ONE_MINUS_SRC_ALPHA）。
+// 图像按水平条带分给多个线程并行光栅化，每个条带内按提交顺序绘制，结果与线程数无关。
+// 不支持ImDrawCmd的UserCallback（跳过）。
+
+// RGBA8图像，每个像素按R、G、B、A字节顺序存放（与IM_COL32相同）
+struct SoftwareImage {
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> pixels;
+
+    void Resize(int newWidth, int newHeight);
+    void Clear(ImU32 color);
+    ImU32 GetPixel(int x, int y) const { return pixels[static_cast<size_t>(y) * width + x]; }
+};
+
+class SoftwareRenderer {
+public:
+    explicit SoftwareRenderer(int threadCount = 0); // 0表示使用全部硬件线程
+    ~SoftwareRenderer();
+    SoftwareRenderer(const SoftwareRenderer&) = delete;
+    SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+
+    // 复制一份RGBA8像素作为纹理，返回可用于ImDrawCmd的纹理ID
+    ImTextureID CreateTexture(const unsigned char* rgba, int width, int height);
+    // 从当前ImGui上下文的字体图集创建纹理并设置TexID
+    void CreateFontsTexture();
+
+    // 把drawData绘制到target上（不清屏，超出target的部分被裁剪）
+    // target通常为DisplaySize * FramebufferScale大小
+    void Render(const ImDrawData* drawData, SoftwareImage& target);
+
+    int GetThreadCount() const;
+
+    // 写出未压缩的PNG文件，成功返回true
+    static bool WritePNG(const std::string& path, const SoftwareImage& image);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
@@ -0,0 +1,119 @@
+// SoftwareRendererTest.cpp
+// CPU渲染后端的像素测试：在前景绘制列表上画不透明矩形、半透明矩形（SIMD和逐像素的尾部都覆盖到）、
+// 被裁剪的矩形和纹理四边形，逐像素检查结果；再加上跨越条带边界的渐变和文字，
+// 检查1个线程和多个线程光栅化出的图像完全相同。
+// 由ctest运行（见CMakeLists.txt）。
+
+#include "SoftwareRenderer.h"
+#include <cstdio>
+
+static int failures = 0;
+
+static void Check(bool condition, const char* what) {
+    std::printf("%s: %s\n", condition ? "ok  " : "FAIL", what);
+    if (!condition) failures++;
+}
+
+constexpr int IMAGE_WIDTH = 64;
+constexpr int IMAGE_HEIGHT = 100; // 大于两个条带的高度，最后一个条带不满
+constexpr ImU32 BACKGROUND = IM_COL32(0, 0, 0, 255);
+constexpr ImU32 RED = IM_COL32(255, 0, 0, 255);
+constexpr ImU32 GREEN = IM_COL32(0, 255, 0, 255);
+constexpr ImU32 TRANSLUCENT_BLUE = IM_COL32(0, 0, 255, 128);
+
+// 2x2纹理，右下角的纹素完全透明
+static const ImU32 TEXELS[4] = {
+    IM_COL32(255, 0, 0, 255), IM_COL32(0, 255, 0, 255),
+    IM_COL32(0, 0, 255, 255), IM_COL32(255, 255, 255, 0),
+};
+
+// 每次用新的上下文画同一帧（纹理ID属于各自的渲染器，不能跨渲染器共用绘制数据）
+static void RenderScene(int threads, bool withText, SoftwareImage& image) {
+    ImGuiContext* context = ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(IMAGE_WIDTH, IMAGE_HEIGHT);
+    io.DeltaTime = 1.0f / 60.0f;
+
+    SoftwareRenderer renderer(threads);
+    renderer.CreateFontsTexture();
+    const ImTextureID texture = renderer.CreateTexture(reinterpret_cast<const unsigned char*>(TEXELS), 2, 2);
+
+    ImGui::NewFrame();
+    ImDrawList* drawList = ImGui::GetForegroundDrawList();
+    drawList->AddRectFilled(ImVec2(4, 4), ImVec2(12, 12), RED);
+    // 12像素宽：左4个像素叠在红色上，共3组SIMD；第二个11像素宽的矩形留下3个像素走逐像素路径
+    drawList->AddRectFilled(ImVec2(8, 6), ImVec2(20, 10), TRANSLUCENT_BLUE);
+    drawList->AddRectFilled(ImVec2(40, 20), ImVec2(51, 22), TRANSLUCENT_BLUE);
+    drawList->PushClipRect(ImVec2(32, 4), ImVec2(40, 12));
+    drawList->AddRectFilled(ImVec2(28, 0), ImVec2(48, 16), GREEN);
+    drawList->PopClipRect();
+    drawList->AddImage(texture, ImVec2(4, 20), ImVec2(12, 28));
+    if (withText) {
+        drawList->AddRectFilledMultiColor(ImVec2(0, 30), ImVec2(IMAGE_WIDTH, IMAGE_HEIGHT),
+            IM_COL32(255, 0, 0, 200), IM_COL32(0, 255, 0, 100), IM_COL32(0, 0, 255, 200), IM_COL32(255, 255, 0, 50));
+        drawList->AddText(ImVec2(2, 56), IM_COL32(255, 255, 255, 230), "Bands 0123");
+    }
+    ImGui::Render();
+
+    image.Resize(IMAGE_WIDTH, IMAGE_HEIGHT);
+    image.Clear(BACKGROUND);
+    renderer.Render(ImGui::GetDrawData(), image);
+    ImGui::DestroyContext(context);
+}
+
+static bool RectIs(const SoftwareImage& image, int x0, int y0, int x1, int y1, ImU32 color) {
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            if (image.GetPixel(x, y) != color) {
+                std::printf("      pixel (%d, %d) = %08X, expected %08X\n", x, y, image.GetPixel(x, y), color);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void TestExactPixels() {
+    SoftwareImage image;
+    RenderScene(1, false, image);
+
+    // 蓝色128/255混合：255 * 128 / 255 = 128，红色剩下255 * 127 / 255 = 127，透明度保持255
+    const ImU32 blueOnBlack = IM_COL32(0, 0, 128, 255);
+    const ImU32 blueOnRed = IM_COL32(127, 0, 128, 255);
+
+    Check(RectIs(image, 4, 4, 12, 6, RED) && RectIs(image, 4, 10, 12, 12, RED) && RectIs(image, 4, 6, 8, 10, RED),
+        "opaque rect covers exactly its pixels");
+    Check(RectIs(image, 3, 3, 13, 4, BACKGROUND) && RectIs(image, 3, 12, 13, 13, BACKGROUND) &&
+        RectIs(image, 3, 4, 4, 12, BACKGROUND), "opaque rect leaves its border untouched");
+    Check(RectIs(image, 8, 6, 12, 10, blueOnRed), "translucent rect blends over the opaque rect");
+    Check(RectIs(image, 12, 6, 20, 10, blueOnBlack) && RectIs(image, 12, 4, 20, 6, BACKGROUND) &&
+        RectIs(image, 20, 6, 21, 10, BACKGROUND), "translucent rect blends over the background");
+    Check(RectIs(image, 40, 20, 51, 22, blueOnBlack) && RectIs(image, 51, 20, 52, 22, BACKGROUND),
+        "translucent span with a scalar tail matches the SIMD part");
+    Check(RectIs(image, 32, 4, 40, 12, GREEN), "clipped rect fills the clip rect");
+    Check(RectIs(image, 28, 0, 32, 16, BACKGROUND) && RectIs(image, 40, 0, 48, 16, BACKGROUND) &&
+        RectIs(image, 32, 0, 40, 4, BACKGROUND) && RectIs(image, 32, 12, 40, 16, BACKGROUND),
+        "clipped rect draws nothing outside the clip rect");
+    Check(RectIs(image, 4, 20, 8, 24, TEXELS[0]) && RectIs(image, 8, 20, 12, 24, TEXELS[1]) &&
+        RectIs(image, 4, 24, 8, 28, TEXELS[2]), "textured quad samples the nearest texel");
+    Check(RectIs(image, 8, 24, 12, 28, BACKGROUND), "transparent texels leave the background");
+}
+
+static void TestThreadCountIndependent() {
+    SoftwareImage serial, parallel;
+    RenderScene(1, true, serial);
+    RenderScene(4, true, parallel);
+    Check(serial.pixels == parallel.pixels, "4 threads render the same pixels as 1 thread");
+
+    // 渐变和文字确实画进了跨条带的区域，相等不是因为什么都没画
+    bool drawn = false;
+    for (int y = 30; y < IMAGE_HEIGHT && !drawn; y++) drawn = serial.GetPixel(IMAGE_WIDTH / 2, y) != BACKGROUND;
+    Check(drawn, "gradient spans several bands");
+}
+
+int main() {
+    TestExactPixels();
+    TestThreadCountIndependent();
+    return failures == 0 ? 0 : 1;
+}
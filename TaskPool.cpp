@@ -0,0 +1,174 @@
+#include "TaskPool.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 每个线程的任务区间[begin, end)，打包在一个64位原子量中，
+// 拥有者从前端取、窃取者从后端取，都用一次CAS完成
+struct alignas(64) WorkRange {
+    std::atomic<uint64_t> range{ 0 };
+
+    static uint64_t Pack(uint32_t begin, uint32_t end) {
+        return (static_cast<uint64_t>(begin) << 32) | end;
+    }
+
+    void Set(uint32_t begin, uint32_t end) {
+        range.store(Pack(begin, end), std::memory_order_release);
+    }
+
+    bool PopFront(int& index) {
+        uint64_t value = range.load(std::memory_order_acquire);
+        for (;;) {
+            const uint32_t begin = static_cast<uint32_t>(value >> 32);
+            const uint32_t end = static_cast<uint32_t>(value);
+            if (begin >= end) return false;
+            if (range.compare_exchange_weak(value, Pack(begin + 1, end), std::memory_order_acq_rel)) {
+                index = static_cast<int>(begin);
+                return true;
+            }
+        }
+    }
+
+    // 窃取后一半（至少一个），返回窃取到的区间
+    bool StealBack(uint32_t& stolenBegin, uint32_t& stolenEnd) {
+        uint64_t value = range.load(std::memory_order_acquire);
+        for (;;) {
+            const uint32_t begin = static_cast<uint32_t>(value >> 32);
+            const uint32_t end = static_cast<uint32_t>(value);
+            if (begin >= end) return false;
+            const uint32_t middle = end - (end - begin + 1) / 2;
+            if (range.compare_exchange_weak(value, Pack(begin, middle), std::memory_order_acq_rel)) {
+                stolenBegin = middle;
+                stolenEnd = end;
+                return true;
+            }
+        }
+    }
+};
+
+} // namespace
+
+struct TaskPool::Impl {
+    // 工作线程：每次ParallelFor发布一个任务（generation加1），各线程执行直到所有区间取完
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    unsigned long long generation = 0;
+    int busyWorkers = 0;
+    bool stopping = false;
+
+    // 当前任务
+    TaskFunc func = nullptr;
+    void* context = nullptr;
+    std::unique_ptr<WorkRange[]> ranges; // 每个线程一个，含调用线程
+    int rangeCount = 0;
+
+    void Execute(int worker) {
+        WorkRange& own = ranges[worker];
+        int index;
+        for (;;) {
+            while (own.PopFront(index)) {
+                func(context, index, worker);
+            }
+
+            // 自己的区间取完，依次尝试从其他线程窃取
+            bool stole = false;
+            for (int offset = 1; offset < rangeCount && !stole; offset++) {
+                uint32_t begin, end;
+                if (ranges[(worker + offset) % rangeCount].StealBack(begin, end)) {
+                    own.Set(begin + 1, end);
+                    func(context, static_cast<int>(begin), worker);
+                    stole = true;
+                }
+            }
+            if (!stole) return; // 所有区间都已取完（正在执行的任务由各自线程完成）
+        }
+    }
+
+    void WorkerMain(int worker) {
+        unsigned long long seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            Execute(worker);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--busyWorkers == 0) done.notify_one();
+            }
+        }
+    }
+};
+
+TaskPool::TaskPool(int threadCount)
+    : impl(std::make_unique<Impl>()) {
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    impl->rangeCount = threadCount;
+    impl->ranges = std::make_unique<WorkRange[]>(threadCount);
+    // 调用ParallelFor的线程也参与执行，编号为0
+    for (int i = 1; i < threadCount; i++) {
+        impl->workers.emplace_back([this, i] { impl->WorkerMain(i); });
+    }
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->stopping = true;
+    }
+    impl->wake.notify_all();
+    for (auto& worker : impl->workers) {
+        worker.join();
+    }
+}
+
+void TaskPool::Run(int count, TaskFunc func, void* context) {
+    if (count <= 0) return;
+
+    // 任务太少或没有工作线程时直接在调用线程执行
+    if (impl->workers.empty() || count == 1) {
+        for (int i = 0; i < count; i++) {
+            func(context, i, 0);
+        }
+        return;
+    }
+
+    impl->func = func;
+    impl->context = context;
+    const int threads = impl->rangeCount;
+    for (int t = 0; t < threads; t++) {
+        const int64_t begin = static_cast<int64_t>(count) * t / threads;
+        const int64_t end = static_cast<int64_t>(count) * (t + 1) / threads;
+        impl->ranges[t].Set(static_cast<uint32_t>(begin), static_cast<uint32_t>(end));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        impl->busyWorkers = static_cast<int>(impl->workers.size());
+        impl->generation++;
+    }
+    impl->wake.notify_all();
+
+    impl->Execute(0);
+
+    std::unique_lock<std::mutex> lock(impl->mutex);
+    impl->done.wait(lock, [&] { return impl->busyWorkers == 0; });
+    impl->func = nullptr;
+    impl->context = nullptr;
+}
+
+int TaskPool::GetThreadCount() const {
+    return impl->rangeCount;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// 工作窃取线程池：ParallelFor把[0, count)均分给各线程，
+// 每个线程从自己区间的前端逐个取任务，取完后从其他线程区间的后端窃取一半。
+// 调用线程也参与执行，返回时所有任务都已完成。执行顺序不确定，
+// 需要确定结果时由任务写入各自的输出槽，再由调用方按下标合并。
+class TaskPool {
+public:
+    explicit TaskPool(int threadCount = 0); // 0表示使用全部硬件线程（含调用线程）
+    ~TaskPool();
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    // 对每个index调用func(index, worker)，worker为执行线程的编号[0, GetThreadCount())，调用线程为0
+    // 不分配堆内存；不可重入（任务中不能再调用ParallelFor）
+    template<typename Func>
+    void ParallelFor(int count, Func&& func) {
+        using FuncType = std::remove_reference_t<Func>;
+        Run(count, [](void* context, int index, int worker) {
+            (*static_cast<FuncType*>(context))(index, worker);
+        }, const_cast<void*>(static_cast<const void*>(&func)));
+    }
+
+    int GetThreadCount() const;
+
+private:
+    using TaskFunc = void (*)(void* context, int index, int worker);
+    void Run(int count, TaskFunc func, void* context);
+
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};